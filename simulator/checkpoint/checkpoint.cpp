@@ -0,0 +1,299 @@
+/*
+ * checkpoint.cpp - architectural state save/restore
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include "checkpoint.h"
+
+#include <infra/endian.h>
+#include <kernel/kernel.h>
+#include <memory/memory.h>
+#include <simulator.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+static const constexpr std::array<char, 8> MAGIC = { 'M', 'I', 'P', 'T', 'C', 'K', 'P', 'T' };
+static const constexpr uint64 VERSION = 1;
+
+// Registers are accessed through 64-bit simulator interface, so wider ones would be truncated
+static void check_register_size( const Simulator& sim)
+{
+    if ( sim.sizeof_register() > bytewidth<uint64>)
+        throw CheckpointError( std::to_string( sim.sizeof_register()) + "-byte registers are not supported");
+}
+
+// Collects non-zero pages written by ReadableMemory::duplicate_to
+class CheckpointPageRecorder : public WriteableMemory
+{
+public:
+    size_t memcpy_host_to_guest( Addr dst, const std::byte* src, size_t size) final
+    {
+        for ( size_t offset = 0; offset < size; ) {
+            const Addr addr = dst + offset;
+            const Addr page_addr = addr - addr % Checkpoint::PAGE_SIZE;
+            const size_t page_offset = addr - page_addr;
+            const size_t chunk = std::min( size - offset, Checkpoint::PAGE_SIZE - page_offset);
+            const auto* chunk_src = src + offset;
+
+            auto it = pages.find( page_addr);
+            if ( it == pages.end() && std::any_of( chunk_src, chunk_src + chunk, []( auto b) { return b != std::byte{}; }))
+                it = pages.emplace( page_addr, std::vector<std::byte>( Checkpoint::PAGE_SIZE)).first;
+
+            if ( it != pages.end())
+                std::copy( chunk_src, chunk_src + chunk, it->second.begin() + page_offset);
+
+            offset += chunk;
+        }
+        return size;
+    }
+
+    auto extract() { return std::move( pages); }
+
+private:
+    std::map<Addr, std::vector<std::byte>> pages;
+};
+
+// Collects addresses of non-zero pages written by ReadableMemory::duplicate_to without keeping their data
+class CheckpointPageEnumerator : public WriteableMemory
+{
+public:
+    size_t memcpy_host_to_guest( Addr dst, const std::byte* src, size_t size) final
+    {
+        for ( size_t offset = 0; offset < size; ) {
+            const Addr addr = dst + offset;
+            const Addr page_addr = addr - addr % Checkpoint::PAGE_SIZE;
+            const size_t chunk = std::min( size - offset, Checkpoint::PAGE_SIZE - ( addr - page_addr));
+            const auto* chunk_src = src + offset;
+            if ( std::any_of( chunk_src, chunk_src + chunk, []( auto b) { return b != std::byte{}; }))
+                pages.insert( page_addr);
+
+            offset += chunk;
+        }
+        return size;
+    }
+
+    auto extract() { return std::move( pages); }
+
+private:
+    std::set<Addr> pages;
+};
+
+static const char* char_cast( const std::byte* b)
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) Casting byte to byte is correct
+    return reinterpret_cast<const char*>( b);
+}
+
+static char* char_cast( std::byte* b)
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) Casting byte to byte is correct
+    return reinterpret_cast<char*>( b);
+}
+
+static void write_uint64( std::ostream& out, uint64 value)
+{
+    const auto bytes = unpack_array_le( value);
+    out.write( char_cast( bytes.data()), bytes.size());
+}
+
+static void write_string( std::ostream& out, const std::string& value)
+{
+    write_uint64( out, value.size());
+    out.write( value.data(), static_cast<std::streamsize>( value.size()));
+}
+
+// Reads the stream keeping the number of consumed bytes, so page data can be found by offsets
+class CheckpointReader
+{
+public:
+    explicit CheckpointReader( std::istream& in) : in( in) { }
+
+    void read( std::byte* dst, size_t size)
+    {
+        if ( !in.read( char_cast( dst), static_cast<std::streamsize>( size)))
+            throw CheckpointError( "unexpected end of file");
+        position += size;
+    }
+
+    uint64 read_uint64()
+    {
+        std::array<std::byte, bytewidth<uint64>> bytes{};
+        read( bytes.data(), bytes.size());
+        return pack_array_le( bytes);
+    }
+
+    std::string read_string()
+    {
+        const auto size = read_uint64();
+        if ( size > MAX_STRING_SIZE)
+            throw CheckpointError( "string of " + std::to_string( size) + " bytes");
+        std::string result( size, '\0');
+        read( byte_cast( result.data()), size);
+        return result;
+    }
+
+    void skip_to( uint64 offset)
+    {
+        if ( offset < position)
+            throw CheckpointError( "page data offsets are not ordered");
+        if ( !in.ignore( static_cast<std::streamsize>( offset - position)))
+            throw CheckpointError( "unexpected end of file");
+        position = offset;
+    }
+
+private:
+    static const constexpr uint64 MAX_STRING_SIZE = 1ULL << 30U;
+    std::istream& in;
+    uint64 position = 0;
+};
+
+Checkpoint Checkpoint::capture( const Simulator& sim, const ReadableMemory& mem, const Kernel& kernel)
+{
+    check_register_size( sim);
+    Checkpoint result;
+    result.isa = sim.get_isa();
+    result.register_size = sim.sizeof_register();
+    result.target = sim.get_target();
+    if ( !result.target.valid)
+        throw CheckpointError( "simulator is not at an instruction boundary");
+
+    result.registers.reserve( sim.max_cpu_register());
+    for ( size_t i = 0; i < sim.max_cpu_register(); ++i)
+        result.registers.push_back( sim.read_cpu_register( i));
+
+    auto recorder = std::make_shared<CheckpointPageRecorder>();
+    mem.duplicate_to( recorder);
+    result.pages = recorder->extract();
+
+    std::ostringstream kernel_state;
+    kernel.save_state( kernel_state);
+    result.kernel_state = std::move( kernel_state).str();
+    return result;
+}
+
+void Checkpoint::save( std::ostream& out) const
+{
+    std::ostringstream header;
+    header.write( MAGIC.data(), MAGIC.size());
+    write_uint64( header, VERSION);
+    write_string( header, isa);
+    write_uint64( header, register_size);
+    write_uint64( header, target.address);
+    write_uint64( header, target.sequence_id);
+    write_uint64( header, registers.size());
+    for ( auto value : registers)
+        write_uint64( header, value);
+    write_string( header, kernel_state);
+    write_uint64( header, pages.size());
+
+    const uint64 table_end = static_cast<uint64>( static_cast<std::streamoff>( header.tellp())) + pages.size() * 2 * bytewidth<uint64>;
+    const uint64 data_offset = ( table_end + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    uint64 offset = data_offset;
+    for ( const auto& page : pages) {
+        write_uint64( header, page.first);
+        write_uint64( header, offset);
+        offset += PAGE_SIZE;
+    }
+
+    const auto& header_data = header.str();
+    out.write( header_data.data(), static_cast<std::streamsize>( header_data.size()));
+    const std::vector<char> padding( data_offset - header_data.size());
+    out.write( padding.data(), static_cast<std::streamsize>( padding.size()));
+    for ( const auto& page : pages)
+        out.write( char_cast( page.second.data()), PAGE_SIZE);
+
+    if ( !out)
+        throw CheckpointError( "cannot write checkpoint");
+}
+
+void Checkpoint::save( const std::string& filename) const
+{
+    std::ofstream out( filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if ( !out.is_open())
+        throw CheckpointError( "cannot open " + filename);
+    save( out);
+}
+
+Checkpoint Checkpoint::load( std::istream& in)
+{
+    CheckpointReader reader( in);
+    std::array<char, MAGIC.size()> magic{};
+    reader.read( byte_cast( magic.data()), magic.size());
+    if ( magic != MAGIC)
+        throw CheckpointError( "not a checkpoint file");
+
+    const auto version = reader.read_uint64();
+    if ( version != VERSION)
+        throw CheckpointError( "unsupported version " + std::to_string( version));
+
+    Checkpoint result;
+    result.isa = reader.read_string();
+    result.register_size = reader.read_uint64();
+    const auto address = reader.read_uint64();
+    const auto sequence_id = reader.read_uint64();
+    result.target = Target( address, sequence_id);
+
+    const auto registers_count = reader.read_uint64();
+    for ( uint64 i = 0; i < registers_count; ++i)
+        result.registers.push_back( reader.read_uint64());
+
+    result.kernel_state = reader.read_string();
+
+    const auto pages_count = reader.read_uint64();
+    std::vector<std::pair<Addr, uint64>> page_table;
+    for ( uint64 i = 0; i < pages_count; ++i) {
+        const auto page_addr = reader.read_uint64();
+        const auto offset = reader.read_uint64();
+        if ( page_addr % PAGE_SIZE != 0 || offset % PAGE_SIZE != 0)
+            throw CheckpointError( "unaligned page");
+        page_table.emplace_back( page_addr, offset);
+    }
+
+    for ( const auto& [page_addr, offset] : page_table) {
+        reader.skip_to( offset);
+        Page page( PAGE_SIZE);
+        reader.read( page.data(), page.size());
+        result.pages.emplace( page_addr, std::move( page));
+    }
+
+    return result;
+}
+
+Checkpoint Checkpoint::load( const std::string& filename)
+{
+    std::ifstream in( filename, std::ios_base::in | std::ios_base::binary);
+    if ( !in.is_open())
+        throw CheckpointError( "cannot open " + filename);
+    return load( in);
+}
+
+void Checkpoint::restore( Simulator* sim, FuncMemory* mem, Kernel* kernel) const
+{
+    if ( sim->get_isa() != isa)
+        throw CheckpointError( "checkpoint of " + isa + " cannot be loaded to " + std::string( sim->get_isa()) + " simulator");
+
+    check_register_size( *sim);
+    if ( sim->sizeof_register() != register_size || sim->max_cpu_register() != registers.size())
+        throw CheckpointError( "register file does not match");
+
+    for ( size_t i = 0; i < registers.size(); ++i)
+        sim->write_cpu_register( i, registers[i]);
+
+    // Zero pages are not saved, so data which has been in memory before restoring is cleared
+    auto enumerator = std::make_shared<CheckpointPageEnumerator>();
+    mem->duplicate_to( enumerator);
+    const Page zero_page( PAGE_SIZE);
+    for ( auto page_addr : enumerator->extract())
+        if ( !pages.contains( page_addr))
+            mem->memcpy_host_to_guest( page_addr, zero_page.data(), zero_page.size());
+
+    for ( const auto& [page_addr, page] : pages)
+        mem->memcpy_host_to_guest( page_addr, page.data(), page.size());
+
+    std::istringstream state( kernel_state);
+    kernel->restore_state( state);
+}
@@ -0,0 +1,73 @@
+/*
+ * checkpoint.h - architectural state save/restore
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <infra/exception.h>
+#include <infra/target.h>
+#include <infra/types.h>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+class FuncMemory;
+class Kernel;
+class ReadableMemory;
+class Simulator;
+
+struct CheckpointError final : Exception
+{
+    explicit CheckpointError( const std::string& msg)
+        : Exception("Bad checkpoint", msg)
+    { }
+};
+
+/*
+ * Architectural state of a program: next target, all CPU registers
+ * (including HI/LO and CSRs, which are mapped to CPU register indices),
+ * non-zero guest memory pages and kernel state such as open files.
+ *
+ * File layout: a header followed by page data at PAGE_SIZE-aligned offsets,
+ * so pages of a saved checkpoint may be mapped directly from the file.
+ * All integers are little-endian.
+ */
+class Checkpoint
+{
+public:
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    static Checkpoint capture( const Simulator& sim, const ReadableMemory& mem, const Kernel& kernel);
+    static Checkpoint load( std::istream& in);
+    static Checkpoint load( const std::string& filename);
+
+    void save( std::ostream& out) const;
+    void save( const std::string& filename) const;
+
+    // Writes registers, memory pages and kernel state.
+    // Memory pages missing in the checkpoint are cleared, so memory may be restored over a loaded image.
+    // Should be called before Simulator::set_kernel, so checker replicas copy the restored state;
+    // the simulator has to be retargeted with get_target() afterwards.
+    void restore( Simulator* sim, FuncMemory* mem, Kernel* kernel) const;
+
+    const std::string& get_isa() const { return isa; }
+    const Target& get_target() const { return target; }
+    const std::vector<uint64>& get_registers() const { return registers; }
+    size_t get_pages_count() const { return pages.size(); }
+
+private:
+    using Page = std::vector<std::byte>;
+
+    std::string isa;
+    size_t register_size = 0;
+    Target target;
+    std::vector<uint64> registers;
+    std::string kernel_state;
+    std::map<Addr, Page> pages;
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,250 @@
+/*
+ * Unit tests for architectural checkpoints
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include <catch.hpp>
+
+#include <checkpoint/checkpoint.h>
+#include <kernel/kernel.h>
+#include <memory/memory.h>
+#include <simulator.h>
+
+#include <iostream>
+#include <sstream>
+
+struct System
+{
+    std::shared_ptr<Simulator> sim;
+    std::shared_ptr<FuncMemory> mem;
+    std::shared_ptr<Kernel> kernel;
+};
+
+static System create_system( const std::string& isa, bool functional_only, std::istream& in, std::ostream& out)
+{
+    System system{ Simulator::create_simulator( isa, functional_only),
+                   FuncMemory::create_default_hierarchied_memory(),
+                   Kernel::create_kernel( true, in, out, out) };
+    system.sim->set_memory( system.mem);
+    system.kernel->set_simulator( system.sim);
+    system.kernel->connect_memory( system.mem);
+    return system;
+}
+
+static System create_loaded_system( const std::string& isa, bool functional_only, std::istream& in, std::ostream& out)
+{
+    auto system = create_system( isa, functional_only, in, out);
+    system.kernel->connect_exception_handler();
+    system.kernel->load_file( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin");
+    system.sim->set_kernel( system.kernel);
+    system.sim->set_pc( system.kernel->get_start_pc());
+    return system;
+}
+
+static System create_restored_system( const Checkpoint& checkpoint, bool functional_only, std::istream& in, std::ostream& out)
+{
+    auto system = create_system( checkpoint.get_isa(), functional_only, in, out);
+    checkpoint.restore( system.sim.get(), system.mem.get(), system.kernel.get());
+    system.sim->set_kernel( system.kernel);
+    system.sim->set_target( checkpoint.get_target());
+    return system;
+}
+
+static Checkpoint save_and_load( const Checkpoint& checkpoint)
+{
+    std::stringstream stream;
+    checkpoint.save( stream);
+    return Checkpoint::load( stream);
+}
+
+static auto run_silent( const std::shared_ptr<Simulator>& sim, uint64 steps)
+{
+    std::ostream nullout( nullptr);
+    OStreamWrapper cout_wrapper( std::cout, nullout);
+    return sim->run( steps);
+}
+
+static void check_same_registers( const Simulator& lhs, const Simulator& rhs)
+{
+    CHECK( lhs.get_pc() == rhs.get_pc());
+    for ( size_t i = 0; i < lhs.max_cpu_register(); ++i)
+        CHECK( lhs.read_cpu_register( i) == rhs.read_cpu_register( i));
+}
+
+TEST_CASE( "Checkpoint: save and load")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto system = create_system( "mips32", true, nullin, nullout);
+    system.sim->set_target( Target( 0x400, 7));
+    system.sim->write_cpu_register( 3, 0xdead'beefU);
+    system.mem->write<uint32, std::endian::little>( 0x1234'5678, 0x12345);
+    system.mem->write<uint32, std::endian::little>( 0, 0x50000);
+
+    auto checkpoint = save_and_load( Checkpoint::capture( *system.sim, *system.mem, *system.kernel));
+    CHECK( checkpoint.get_isa() == "mips32");
+    CHECK( checkpoint.get_target().address == 0x400);
+    CHECK( checkpoint.get_target().sequence_id == 7);
+    CHECK( checkpoint.get_registers().at( 3) == 0xdead'beefU);
+    CHECK( checkpoint.get_pages_count() == 1);
+
+    auto restored = create_system( "mips32", true, nullin, nullout);
+    checkpoint.restore( restored.sim.get(), restored.mem.get(), restored.kernel.get());
+    CHECK( restored.sim->read_cpu_register( 3) == 0xdead'beefU);
+    CHECK( restored.mem->read<uint32, std::endian::little>( 0x12345) == 0x1234'5678);
+}
+
+TEST_CASE( "Checkpoint: pages are aligned in the file")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto system = create_system( "mips32", true, nullin, nullout);
+    system.sim->set_pc( 0x400);
+    system.mem->write<uint32, std::endian::little>( 0x1234'5678, 0x12345);
+
+    std::ostringstream stream;
+    Checkpoint::capture( *system.sim, *system.mem, *system.kernel).save( stream);
+    const auto& data = stream.str();
+    REQUIRE( data.size() == 2 * Checkpoint::PAGE_SIZE);
+    CHECK( uint8( data[Checkpoint::PAGE_SIZE + 0x345]) == 0x78);
+}
+
+TEST_CASE( "Checkpoint: bad files")
+{
+    std::istringstream garbage( "this is not a checkpoint");
+    CHECK_THROWS_AS( Checkpoint::load( garbage), CheckpointError);
+    CHECK_THROWS_AS( Checkpoint::load( "/ksagklhfgldg/sgsfgdsfgadg"), CheckpointError);
+
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto system = create_system( "mips32", true, nullin, nullout);
+    system.sim->set_pc( 0x400);
+    system.mem->write<uint32, std::endian::little>( 0x1234'5678, 0x12345);
+    std::ostringstream stream;
+    Checkpoint::capture( *system.sim, *system.mem, *system.kernel).save( stream);
+
+    std::istringstream truncated( stream.str().substr( 0, Checkpoint::PAGE_SIZE + 1));
+    CHECK_THROWS_AS( Checkpoint::load( truncated), CheckpointError);
+
+    std::istringstream full( stream.str());
+    auto checkpoint = Checkpoint::load( full);
+    auto riscv = create_system( "riscv32", true, nullin, nullout);
+    CHECK_THROWS_AS( checkpoint.restore( riscv.sim.get(), riscv.mem.get(), riscv.kernel.get()), CheckpointError);
+}
+
+TEST_CASE( "Checkpoint: riscv128")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto riscv128 = create_system( "riscv128", true, nullin, nullout);
+    riscv128.sim->set_pc( 0x400);
+    CHECK_THROWS_AS( Checkpoint::capture( *riscv128.sim, *riscv128.mem, *riscv128.kernel), CheckpointError);
+
+    // Make a file of riscv128 from the one of riscv64, they differ only by the name of ISA
+    auto riscv64 = create_system( "riscv64", true, nullin, nullout);
+    riscv64.sim->set_pc( 0x400);
+    std::ostringstream stream;
+    Checkpoint::capture( *riscv64.sim, *riscv64.mem, *riscv64.kernel).save( stream);
+    auto data = stream.str();
+    const std::string riscv64_name( "\x07\0\0\0\0\0\0\0riscv64", 15);
+    const auto pos = data.find( riscv64_name);
+    REQUIRE( pos != std::string::npos);
+    data.replace( pos, riscv64_name.size(), std::string( "\x08\0\0\0\0\0\0\0riscv128", 16));
+
+    std::istringstream patched( data);
+    auto checkpoint = Checkpoint::load( patched);
+    CHECK( checkpoint.get_isa() == "riscv128");
+    CHECK_THROWS_AS( checkpoint.restore( riscv128.sim.get(), riscv128.mem.get(), riscv128.kernel.get()), CheckpointError);
+}
+
+TEST_CASE( "Checkpoint: restore over a loaded image")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto system = create_system( "mips32", true, nullin, nullout);
+    system.sim->set_pc( 0x400);
+    system.mem->write<uint32, std::endian::little>( 0x1234'5678, 0x12345);
+    system.mem->write<uint32, std::endian::little>( 0x1234'5678, 0x20000);
+    system.mem->write<uint32, std::endian::little>( 0, 0x20000);
+    auto checkpoint = save_and_load( Checkpoint::capture( *system.sim, *system.mem, *system.kernel));
+
+    auto restored = create_system( "mips32", true, nullin, nullout);
+    restored.mem->write<uint32, std::endian::little>( 0xdead'beef, 0x20000);
+    restored.mem->write<uint32, std::endian::little>( 0xdead'beef, 0x30000);
+    restored.mem->write<uint32, std::endian::little>( 0xdead'beef, 0x12000);
+    checkpoint.restore( restored.sim.get(), restored.mem.get(), restored.kernel.get());
+    CHECK( restored.mem->read<uint32, std::endian::little>( 0x12345) == 0x1234'5678);
+    CHECK( restored.mem->read<uint32, std::endian::little>( 0x12000) == 0);
+    CHECK( restored.mem->read<uint32, std::endian::little>( 0x20000) == 0);
+    CHECK( restored.mem->read<uint32, std::endian::little>( 0x30000) == 0);
+}
+
+TEST_CASE( "Checkpoint: resume FuncSim over the loaded binary")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto reference = create_loaded_system( "mars", true, nullin, nullout);
+    CHECK( reference.sim->run( 1000) == Trap::BREAKPOINT);
+
+    auto checkpoint = save_and_load( Checkpoint::capture( *reference.sim, *reference.mem, *reference.kernel));
+
+    // Same as the standalone simulator did: the image is loaded first, then the checkpoint is restored over it
+    auto restored = create_system( "mars", true, nullin, nullout);
+    restored.kernel->connect_exception_handler();
+    restored.kernel->load_file( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin");
+    checkpoint.restore( restored.sim.get(), restored.mem.get(), restored.kernel.get());
+    restored.sim->set_kernel( restored.kernel);
+    restored.sim->set_target( checkpoint.get_target());
+    CHECK( reference.mem->dump() == restored.mem->dump());
+
+    CHECK( reference.sim->run_no_limit() == Trap::HALT);
+    CHECK( restored.sim->run_no_limit() == Trap::HALT);
+    check_same_registers( *reference.sim, *restored.sim);
+}
+
+TEST_CASE( "Checkpoint: resume FuncSim")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto reference = create_loaded_system( "mars", true, nullin, nullout);
+    CHECK( reference.sim->run( 1000) == Trap::BREAKPOINT);
+
+    auto checkpoint = save_and_load( Checkpoint::capture( *reference.sim, *reference.mem, *reference.kernel));
+
+    auto restored = create_restored_system( checkpoint, true, nullin, nullout);
+    CHECK( reference.sim->run_no_limit() == Trap::HALT);
+    CHECK( restored.sim->run_no_limit() == Trap::HALT);
+    check_same_registers( *reference.sim, *restored.sim);
+}
+
+TEST_CASE( "Checkpoint: FuncSim to PerfSim")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto reference = create_loaded_system( "mars", true, nullin, nullout);
+    CHECK( reference.sim->run( 1000) == Trap::BREAKPOINT);
+
+    auto checkpoint = save_and_load( Checkpoint::capture( *reference.sim, *reference.mem, *reference.kernel));
+
+    // Checker of PerfSim validates the restored state as well
+    auto restored = create_restored_system( checkpoint, false, nullin, nullout);
+    CHECK( reference.sim->run_no_limit() == Trap::HALT);
+    CHECK( run_silent( restored.sim, MAX_VAL64) == Trap::HALT);
+    check_same_registers( *reference.sim, *restored.sim);
+}
+
+TEST_CASE( "Checkpoint: PerfSim to FuncSim")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto perf = create_loaded_system( "mars", false, nullin, nullout);
+    run_silent( perf.sim, 1000);
+
+    auto checkpoint = save_and_load( Checkpoint::capture( *perf.sim, *perf.mem, *perf.kernel));
+
+    auto reference = create_loaded_system( "mars", true, nullin, nullout);
+    auto restored = create_restored_system( checkpoint, true, nullin, nullout);
+    CHECK( reference.sim->run_no_limit() == Trap::HALT);
+    CHECK( restored.sim->run_no_limit() == Trap::HALT);
+    check_same_registers( *reference.sim, *restored.sim);
+}
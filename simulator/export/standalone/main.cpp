@@ -5,18 +5,47 @@
  */
 
 /* Simulator modules. */
+#include <checkpoint/checkpoint.h>
 #include <infra/config/config.h>
 #include <infra/config/main_wrapper.h>
 #include <kernel/kernel.h>
 #include <memory/memory.h>
+#include <modules/core/sampling.h>
+#include <simpoint/interval_sim.h>
+#include <simpoint/simpoint.h>
 #include <simulator.h>
 
+#include <iostream>
+
 namespace config {
-    static const AliasedRequiredValue<std::string> binary_filename = { "b", "binary", "input binary file"};
+    static const AliasedValue<std::string> binary_filename = { "b", "binary", "", "input binary file"};
     static const AliasedValue<uint64> num_steps = { "n", "numsteps", MAX_VAL64, "number of instructions to run"};
     static const Value<std::string> trap_mode = { "trap_mode",  "", "trap handler mode"};
+    static const Value<std::string> load_checkpoint = { "load-checkpoint", "", "checkpoint to start simulation from"};
+    static const Value<std::string> save_checkpoint = { "save-checkpoint", "", "checkpoint to save after simulation"};
+    static const Value<std::string> bbv_file = { "bbv", "", "file to write basic block vectors in SimPoint format"};
+    static const Value<uint64> bbv_interval = { "bbv-interval", 100'000'000, "number of instructions in a basic block vector"};
+    static const Value<std::string> simpoints = { "simpoints", "", "prefix of .simpoints and .weights files to select representative intervals"};
+    static const Value<uint32> simpoints_max_k = { "simpoints-max-k", 10, "maximum number of clusters of basic block vectors"};
+    static const Value<std::string> simulate_simpoints = { "simulate-simpoints", "", "prefix of .simpoints and .weights files to simulate intervals of in parallel"};
+    static const Value<uint64> simpoints_warm_up = { "simpoints-warm-up", 1'000'000, "number of instructions to warm up before each simulated interval"};
+    static const Value<uint32> simpoints_threads = { "simpoints-threads", 0, "number of threads to simulate intervals, zero means all host threads"};
 } // namespace config
 
+// Captures checkpoints by functional simulation, each interval is simulated by its own performance simulator meanwhile
+static void run_simpoints( Simulator* sim, const ReadableMemory& memory, const Kernel& kernel, const std::string& prefix)
+{
+    IntervalSimParameters params;
+    params.threads = config::simpoints_threads;
+    params.is_mars_kernel = Kernel::is_mars_configured();
+    const auto results = simulate_simpoints( sim, memory, kernel, load_simpoints( prefix), config::bbv_interval, config::simpoints_warm_up, params);
+    if ( results.skipped_points != 0)
+        std::cerr << "Warning: program ends before the last " << results.skipped_points << " simulation point(s) of total weight "
+                  << results.skipped_weight << ", the estimation covers the reached ones only" << std::endl;
+
+    std::cout << merge_intervals( results.intervals);
+}
+
 class Main : public MainWrapper
 {
     using MainWrapper::MainWrapper;
@@ -28,9 +57,17 @@ private:
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays, modernize-avoid-c-arrays, hicpp-avoid-c-arrays)
 int Main::impl( int argc, const char* argv[]) const {
     config::handleArgs( argc, argv, 1);
-    auto memory = FuncMemory::create_default_hierarchied_memory();
+    const std::string& binary_filename = config::binary_filename;
+    const std::string& load_checkpoint = config::load_checkpoint;
+    const std::string& save_checkpoint = config::save_checkpoint;
+    if ( binary_filename.empty() && load_checkpoint.empty())
+        throw config::InvalidOption( "either binary or checkpoint to load is required");
+
+    auto memory = FuncMemory::create_configured_memory();
 
-    auto sim = Simulator::create_configured_simulator();
+    const std::string& simpoints_to_simulate = config::simulate_simpoints;
+    auto sim = simpoints_to_simulate.empty() ? Simulator::create_configured_simulator()
+                                             : Simulator::create_functional_simulator( Simulator::get_configured_isa());
     sim->set_memory( memory);
     sim->write_csr_register( "mscratch", 0x400'0000);
 
@@ -38,11 +75,53 @@ int Main::impl( int argc, const char* argv[]) const {
     kernel->set_simulator( sim);
     kernel->connect_memory( memory);
     kernel->connect_exception_handler();
-    kernel->load_file( config::binary_filename);
+
+    Target target;
+    if ( !binary_filename.empty()) {
+        kernel->load_file( binary_filename);
+        target = Target( kernel->get_start_pc(), 0);
+    }
+
+    if ( !load_checkpoint.empty()) {
+        // Checkpoint has the whole memory image and replaces the binary if it is loaded
+        const auto checkpoint = Checkpoint::load( load_checkpoint);
+        checkpoint.restore( sim.get(), memory.get(), kernel.get());
+        target = checkpoint.get_target();
+    }
     sim->set_kernel( kernel);
 
-    sim->set_pc( kernel->get_start_pc());
+    const std::string& bbv_file = config::bbv_file;
+    const std::string& simpoints = config::simpoints;
+    std::shared_ptr<BBVProfiler> profiler;
+    if ( !bbv_file.empty() || !simpoints.empty()) {
+        profiler = std::make_shared<BBVProfiler>( config::bbv_interval);
+        sim->set_bbv_profiler( profiler);
+    }
+
+    sim->set_target( target);
+    if ( !simpoints_to_simulate.empty()) {
+        run_simpoints( sim.get(), *memory, *kernel, simpoints_to_simulate);
+        return 0;
+    }
+
     sim->run( config::num_steps);
+    if ( const auto* report = sim->get_sampling_report(); report != nullptr)
+        std::cout << *report;
+
+    if ( !save_checkpoint.empty())
+        Checkpoint::capture( *sim, *memory, *kernel).save( save_checkpoint);
+
+    if ( profiler != nullptr) {
+        profiler->finish();
+        if ( !bbv_file.empty())
+            profiler->save( bbv_file);
+        if ( !simpoints.empty()) {
+            SimPointParameters params;
+            params.max_clusters = config::simpoints_max_k;
+            save_simpoints( select_simpoints( profiler->get_intervals(), params), simpoints);
+        }
+    }
+
     return sim->get_exit_code();
 }
 
@@ -0,0 +1,60 @@
+/**
+ * main.cpp - simulation of a program over a grid of configurations
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include <infra/config/config.h>
+#include <infra/config/main_wrapper.h>
+#include <sweep/sweep.h>
+
+#include <fstream>
+#include <iostream>
+
+namespace config {
+    static const AliasedRequiredValue<std::string> binary_filename = { "b", "binary", "input binary file"};
+    static const AliasedRequiredValue<std::string> grid = { "g", "grid", "file with option values to sweep"};
+    static const AliasedValue<uint64> num_steps = { "n", "numsteps", MAX_VAL64, "number of instructions to run for each configuration"};
+    static const AliasedValue<uint32> threads = { "j", "threads", 0, "number of host threads, zero means all of them"};
+    static const Value<std::string> csv = { "csv", "", "file to write results in CSV format"};
+    static const Value<std::string> json = { "json", "", "file to write results in JSON format"};
+} // namespace config
+
+static void save( const std::vector<SweepResult>& results, const std::string& filename,
+                  void ( *saver)( const std::vector<SweepResult>&, std::ostream&))
+{
+    if ( filename.empty())
+        return;
+
+    std::ofstream out( filename);
+    if ( !out.is_open())
+        throw SweepError( "cannot open " + filename);
+    saver( results, out);
+}
+
+class Main : public MainWrapper
+{
+    using MainWrapper::MainWrapper;
+private:
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays, modernize-avoid-c-arrays, hicpp-avoid-c-arrays)
+    int impl( int argc, const char* argv[]) const final {
+        config::handleArgs( argc, argv, 1);
+        const auto points = parse_sweep_grid( config::grid);
+        const auto start = load_sweep_program( config::binary_filename);
+
+        SweepParameters params;
+        params.instrs = config::num_steps;
+        params.threads = config::threads;
+        const auto results = run_sweep( start, points, params);
+
+        save( results, config::csv, save_sweep_csv);
+        save( results, config::json, save_sweep_json);
+        if ( std::string( config::csv).empty() && std::string( config::json).empty())
+            save_sweep_csv( results, std::cout);
+        return 0;
+    }
+};
+
+int main( int argc, const char* argv[])
+{
+    return Main( "MIPT-MIPS simulation over a grid of configurations.").run( argc, argv);
+}
@@ -21,6 +21,8 @@ class Driver : public Log
 public:
     static std::unique_ptr<Driver> create_default_driver();
     static std::unique_ptr<Driver> create_hooked_driver( const Driver* drv);
+    // Must have no side effects for instructions without traps,
+    // so simulators are allowed to skip the call for them
     virtual Trap handle_trap( const Operation& instr) const = 0;
     virtual std::unique_ptr<Driver> clone() const = 0;
 };
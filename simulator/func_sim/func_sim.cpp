@@ -14,7 +14,8 @@
 template <ISA I>
 FuncSim<I>::FuncSim( std::endian endian, bool log, std::string_view isa)
     : BasicFuncSim( isa)
-    , imem( endian)
+    , imem( endian, InstrCacheParameters::create_configured())
+    , bb_cache( endian)
     , driver( I::create_driver( this))
 {
     if ( log)
@@ -26,6 +27,19 @@ void FuncSim<I>::set_memory( std::shared_ptr<FuncMemory> m)
 {
     mem = std::move( m);
     imem.set_memory( mem);
+    bb_cache.set_memory( mem);
+}
+
+template <ISA I>
+void FuncSim<I>::reset()
+{
+    rf.reset();
+    sequence_id = 0;
+    executed_instrs = 0;
+    pc = {};
+    delayed_slots = 0;
+    nops_in_a_row = 0;
+    kernel = nullptr;
 }
 
 template <ISA I>
@@ -41,17 +55,24 @@ void FuncSim<I>::update_and_check_nop_counter( const FuncInstr& instr)
 }
 
 template <ISA I>
-typename FuncSim<I>::FuncInstr FuncSim<I>::step()
+void FuncSim<I>::process( FuncInstr* instr)
 {
-    FuncInstr instr = imem.fetch_instr( pc[0]);
-    instr.set_sequence_id(sequence_id);
+    instr->set_sequence_id(sequence_id);
     sequence_id++;
-    rf.read_sources( &instr);
-    instr.execute();
-    mem->load_store( &instr);
-    rf.write_dst( instr);
-    update_pc( instr);
-    update_and_check_nop_counter( instr);
+    executed_instrs++;
+    rf.read_sources( instr);
+    instr->execute();
+    mem->load_store( instr);
+    rf.write_dst( *instr);
+    update_pc( *instr);
+    update_and_check_nop_counter( *instr);
+}
+
+template <ISA I>
+typename FuncSim<I>::FuncInstr FuncSim<I>::step()
+{
+    FuncInstr instr = imem.get_instr( pc[0]);
+    process( &instr);
     return instr;
 }
 
@@ -80,17 +101,58 @@ Trap FuncSim<I>::driver_step( const Operation& instr)
     return driver->handle_trap( instr);
 }
 
+template <ISA I>
+Trap FuncSim<I>::complete( FuncInstr* instr)
+{
+    sout << *instr << std::endl;
+    kernel->handle_instruction( instr);
+    return driver_step( *instr);
+}
+
 template <ISA I>
 Trap FuncSim<I>::run( uint64 instrs_to_run)
 {
     nops_in_a_row = 0;
-    for ( uint64 i = 0; i < instrs_to_run; ++i) {
-        auto instr = step();
-        sout << instr << std::endl;
-        kernel->handle_instruction( &instr);
-        auto result_trap = driver_step( instr);
-        if ( result_trap != Trap::NO_TRAP)
-            return result_trap;
+    // Logging and driver hooks observe every instruction,
+    // otherwise kernel and driver have nothing to do with instructions without traps
+    if ( sout.enabled() || has_driver_hooks)
+        return observer != nullptr ? run_blocks<true, true>( instrs_to_run) : run_blocks<true, false>( instrs_to_run);
+
+    return observer != nullptr ? run_blocks<false, true>( instrs_to_run) : run_blocks<false, false>( instrs_to_run);
+}
+
+template <ISA I>
+template <bool visit_all, bool observe>
+Trap FuncSim<I>::run_blocks( uint64 instrs_to_run)
+{
+    uint64 i = 0;
+    while ( i < instrs_to_run) {
+        const Addr block_pc = pc[0];
+        const auto& block = bb_cache.fetch_block( block_pc);
+        bool is_modified = false;
+        for ( const auto& decoded : block.instrs) {
+            // Control flow might have left the block before its end, e.g. on a taken delayed branch
+            if ( i == instrs_to_run || decoded.get_PC() != pc[0])
+                break;
+            if ( !bb_cache.is_valid( block, decoded)) {
+                is_modified = true;
+                break;
+            }
+            auto instr = decoded;
+            process( &instr);
+            ++i;
+            if constexpr ( observe)
+                observer->observe( instr);
+
+            if ( !visit_all && !instr.has_trap())
+                continue;
+
+            auto result_trap = complete( &instr);
+            if ( result_trap != Trap::NO_TRAP)
+                return result_trap;
+        }
+        if ( is_modified)
+            bb_cache.invalidate_block( block_pc);
     }
     return Trap(Trap::BREAKPOINT);
 }
@@ -123,6 +185,7 @@ template <ISA I>
 void FuncSim<I>::enable_driver_hooks()
 {
     driver = Driver::create_hooked_driver( driver.get());
+    has_driver_hooks = true;
 }
 
 #include <mips/mips.h>
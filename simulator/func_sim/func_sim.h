@@ -14,6 +14,7 @@
 #include <infra/config/config.h>
 #include <infra/exception.h>
 #include <memory/memory.h>
+#include <simpoint/bbv.h>
 #include <simulator.h>
 
 #include <memory>
@@ -28,6 +29,21 @@ protected:
     explicit BasicFuncSim( std::string_view isa) : Simulator( isa) { }
 };
 
+// Receives instructions executed by FuncSim::run, e.g. to warm up microarchitectural structures
+template <typename FuncInstr>
+class FuncSimObserver
+{
+public:
+    FuncSimObserver() = default;
+    virtual ~FuncSimObserver() = default;
+    FuncSimObserver( const FuncSimObserver&) = delete;
+    FuncSimObserver( FuncSimObserver&&) = delete;
+    FuncSimObserver& operator=( const FuncSimObserver&) = delete;
+    FuncSimObserver& operator=( FuncSimObserver&&) = delete;
+
+    virtual void observe( const FuncInstr& instr) = 0;
+};
+
 template <ISA I>
 class FuncSim : public BasicFuncSim
 {
@@ -38,8 +54,10 @@ class FuncSim : public BasicFuncSim
     private:
         RF<FuncInstr> rf;
         uint64 sequence_id = 0;
+        uint64 executed_instrs = 0;
         std::shared_ptr<FuncMemory> mem;
         InstrMemoryCached<I> imem;
+        BasicBlockCache<I> bb_cache;
         std::shared_ptr<Kernel> kernel;
         std::unique_ptr<Driver> driver;
 
@@ -50,6 +68,23 @@ class FuncSim : public BasicFuncSim
         uint64 nops_in_a_row = 0;
         void update_and_check_nop_counter( const FuncInstr& instr);
 
+        bool has_driver_hooks = false;
+        FuncSimObserver<FuncInstr>* observer = nullptr;
+
+        class BBVObserver final : public FuncSimObserver<FuncInstr>
+        {
+        public:
+            explicit BBVObserver( std::shared_ptr<BBVProfiler> profiler) : profiler( std::move( profiler)) { }
+            void observe( const FuncInstr& instr) final { profiler->add_instruction( instr.get_PC(), instr.ends_basic_block()); }
+        private:
+            const std::shared_ptr<BBVProfiler> profiler;
+        };
+        std::unique_ptr<BBVObserver> bbv_observer;
+
+        void process( FuncInstr* instr);
+        Trap complete( FuncInstr* instr);
+        template<bool visit_all, bool observe> Trap run_blocks( uint64 instrs_to_run);
+
         uint64 read_register( Register index) const { return narrow_cast<uint64>( rf.read( index)); }
         void write_register( Register index, uint64 value) { rf.write( index, narrow_cast<RegisterUInt>( value)); }
 
@@ -64,6 +99,14 @@ class FuncSim : public BasicFuncSim
         FuncInstr step();
         Trap driver_step( const Operation& instr);
         Trap run( uint64 instrs_to_run) final;
+        void set_observer( FuncSimObserver<FuncInstr>* value) { observer = value; }
+        void set_bbv_profiler( std::shared_ptr<BBVProfiler> profiler) final
+        {
+            bbv_observer = std::make_unique<BBVObserver>( std::move( profiler));
+            set_observer( bbv_observer.get());
+        }
+        uint64 get_executed_instrs() const final { return executed_instrs; }
+        void reset() final;
 
         void set_target(const Target& target) final {
             pc[0] = target.address;
@@ -71,6 +114,24 @@ class FuncSim : public BasicFuncSim
             sequence_id = target.sequence_id;
         }
         Addr get_pc() const final { return pc[0]; }
+        Target get_target() const final { return delayed_slots == 0 ? Target( pc[0], sequence_id) : Target(); }
+
+        // Registers and program counters, execution may be replayed from them over a memory snapshot
+        struct State
+        {
+            RF<FuncInstr> rf;
+            std::array<Addr, 8> pc = {};
+            size_t delayed_slots = 0;
+            uint64 sequence_id = 0;
+        };
+        State get_state() const { return { rf, pc, delayed_slots, sequence_id}; }
+        void set_state( const State& state)
+        {
+            rf = state.rf;
+            pc = state.pc;
+            delayed_slots = state.delayed_slots;
+            sequence_id = state.sequence_id;
+        }
 
         size_t sizeof_register() const final { return bytewidth<RegisterUInt>; }
         size_t max_cpu_register() const final { return Register::MAX_REG; }
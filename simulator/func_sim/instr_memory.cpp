@@ -0,0 +1,19 @@
+/*
+ * instr_memory.cpp - configuration of decoded instructions cache
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include <infra/config/config.h>
+
+#include "instr_memory.h"
+
+namespace config {
+    static const Value<std::string> instr_cache_type = { "instr-cache-type", "LRU", "Type of decoded instructions cache (LRU, set-associative)"};
+    static const Value<uint32> instr_cache_size = { "instr-cache-size", INSTR_CACHE_CAPACITY, "Capacity of set-associative decoded instructions cache (in instructions)"};
+    static const Value<uint32> instr_cache_ways = { "instr-cache-ways", 1, "Amount of ways in set-associative decoded instructions cache"};
+} // namespace config
+
+InstrCacheParameters InstrCacheParameters::create_configured()
+{
+    return { config::instr_cache_type, config::instr_cache_size, config::instr_cache_ways};
+}
@@ -7,15 +7,24 @@
 #define INSTR_CACHE_H
 
 #include <func_sim/isa.h>
+#include <infra/exception.h>
 #include <infra/instrcache/instr_cache.h>
+#include <infra/instrcache/set_associative_instr_cache.h>
 #include <infra/types.h>
 #include <memory/memory.h>
 
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 template<Executable FuncInstr>
 class InstrMemoryIface
 {
 public:
-    explicit InstrMemoryIface( std::endian e) : endian( e) { }
+    explicit InstrMemoryIface( std::endian e) : endian( e) { generations.fill( { all_ones<Addr>(), nullptr}); }
     auto fetch( Addr pc) const
     {
         return endian == std::endian::little
@@ -24,7 +33,30 @@ public:
     }
     auto get_endian() const { return endian; }
 
-    void set_memory( const std::shared_ptr<ReadableMemory>& m) { mem = m; }
+    void set_memory( const std::shared_ptr<ReadableMemory>& m)
+    {
+        mem = m;
+        generations.fill( { all_ones<Addr>(), nullptr});
+    }
+
+    // Grows after any byte of the instruction word at PC is overwritten.
+    // std::nullopt means that the memory does not count writes, so the word has to be compared instead.
+    std::optional<uint64> get_write_generation( Addr pc) const
+    {
+        const auto* first = get_page_generation( pc);
+        const auto* last = get_page_generation( pc + bytewidth<uint32> - 1);
+        if ( first == nullptr || last == nullptr)
+            return std::nullopt;
+        return std::max( *first, *last);
+    }
+
+    // Write generation if the memory counts writes, or the instruction word otherwise
+    uint64 get_stamp( Addr pc) const
+    {
+        const auto generation = get_write_generation( pc);
+        return generation.has_value() ? *generation : fetch( pc);
+    }
+
     virtual FuncInstr fetch_instr( Addr PC) = 0;
 
     virtual ~InstrMemoryIface() = default;
@@ -34,8 +66,19 @@ public:
     InstrMemoryIface& operator=( InstrMemoryIface&&) noexcept = default;
 
 private:
+    const uint64* get_page_generation( Addr addr) const
+    {
+        const Addr page = addr >> ReadableMemory::GENERATION_PAGE_BITS;
+        auto& entry = generations[ page % generations.size()];
+        if ( entry.first != page)
+            entry = { page, mem->get_page_generation( addr)};
+        return entry.second;
+    }
+
     std::shared_ptr<ReadableMemory> mem = nullptr;
     const std::endian endian;
+    // Generation counters are not moved by memory, so pointers for recently fetched pages are kept
+    mutable std::array<std::pair<Addr, const uint64*>, 16> generations = {};
 };
 
 template<ISA I>
@@ -51,28 +94,177 @@ public:
 #define INSTR_CACHE_CAPACITY 8192
 #endif
 
+struct InstrCacheParameters
+{
+    // "LRU" is a fully-associative cache of INSTR_CACHE_CAPACITY instructions,
+    // "set-associative" is a cache of 'capacity' instructions split to sets of 'ways' instructions
+    std::string type = "LRU";
+    size_t capacity = INSTR_CACHE_CAPACITY;
+    size_t ways = 1;
+
+    static InstrCacheParameters create_configured();
+};
+
+struct InstrCacheInvalidTypeException final : Exception
+{
+    explicit InstrCacheInvalidTypeException(const std::string& msg)
+        : Exception("Invalid instruction cache type", msg)
+    { }
+};
+
 template<ISA I>
 class InstrMemoryCached : public InstrMemory<I>
 {
     using Instr = typename I::FuncInstr;
-    InstrCache<Addr, Instr, INSTR_CACHE_CAPACITY, 0x0, all_ones<Addr>()> instr_cache{};
 public:
-    explicit InstrMemoryCached( std::endian endian) : InstrMemory<I>( endian) { }
-    Instr fetch_instr( Addr PC) final
+    explicit InstrMemoryCached( std::endian endian, const InstrCacheParameters& params = {})
+        : InstrMemory<I>( endian)
+        , is_set_associative( params.type != "LRU")
+        , set_associative_cache( is_set_associative ? params.capacity : 1, is_set_associative ? params.ways : 1)
+    {
+        if ( is_set_associative && params.type != "set-associative")
+            throw InstrCacheInvalidTypeException( params.type);
+    }
+
+    Instr fetch_instr( Addr PC) final { return get_instr( PC); }
+
+    // Reference is valid until the next call
+    const Instr& get_instr( Addr PC)
+    {
+        const auto stamp = this->get_stamp( PC);
+        return is_set_associative ? get_set_associative( PC, stamp) : get_lru( PC, stamp);
+    }
+
+    auto get_hits() const { return hits; }
+    auto get_misses() const { return misses; }
+
+private:
+    struct StampedInstr
+    {
+        uint64 stamp;
+        Instr instr;
+    };
+
+    const Instr& get_set_associative( Addr PC, uint64 stamp)
+    {
+        const auto* value = set_associative_cache.find( PC, stamp);
+        if ( value != nullptr) {
+            ++hits;
+            return *value;
+        }
+        ++misses;
+        return set_associative_cache.update( PC, stamp, InstrMemory<I>::fetch_instr( PC));
+    }
+
+    const Instr& get_lru( Addr PC, uint64 stamp)
     {
-        const auto [found, value] = instr_cache.find( PC);
-        if ( found && value.is_same_bytes( this->fetch( PC))) {
-            instr_cache.touch( PC);
-            return value;
+        const auto [found, value] = lru_cache.find( PC);
+        if ( found && value.stamp == stamp) {
+            ++hits;
+            lru_cache.touch( PC);
+            return value.instr;
         }
+        ++misses;
         if ( found)
-            instr_cache.erase( PC);
+            lru_cache.erase( PC);
 
-        auto instr = InstrMemory<I>::fetch_instr( PC);
-        if ( PC != 0)
-            instr_cache.update( PC, instr);
-        return instr;
+        if ( PC == 0 || PC == all_ones<Addr>()) {
+            uncached_instr.emplace( InstrMemory<I>::fetch_instr( PC));
+            return *uncached_instr;
+        }
+
+        lru_cache.update( PC, StampedInstr{ stamp, InstrMemory<I>::fetch_instr( PC)});
+        return lru_cache.find( PC).second.instr;
+    }
+
+    const bool is_set_associative;
+    InstrCache<Addr, StampedInstr, INSTR_CACHE_CAPACITY, 0x0, all_ones<Addr>()> lru_cache{};
+    SetAssociativeInstrCache<Addr, Instr> set_associative_cache;
+    std::optional<Instr> uncached_instr;
+    uint64 hits = 0;
+    uint64 misses = 0;
+};
+
+#ifndef BASIC_BLOCK_CACHE_CAPACITY
+#define BASIC_BLOCK_CACHE_CAPACITY 1024
+#endif
+
+/*
+ * Keeps pre-decoded instructions grouped into basic blocks,
+ * so functional simulator does one lookup per block instead of one per instruction.
+ * A block starts at its key PC and ends with a jump, a branch, a syscall or a trap.
+ */
+template<ISA I>
+class BasicBlockCache : public InstrMemory<I>
+{
+    using Instr = typename I::FuncInstr;
+public:
+    struct Block
+    {
+        std::vector<Instr> instrs;
+        // The highest write generation of block pages, if memory counts writes
+        std::optional<uint64> generation;
+    };
+    static constexpr size_t MAX_BLOCK_SIZE = 64;
+
+    explicit BasicBlockCache( std::endian endian) : InstrMemory<I>( endian) { }
+
+    const Block& fetch_block( Addr PC)
+    {
+        if ( !is_cacheable( PC)) {
+            uncached_block = decode_block( PC);
+            return uncached_block;
+        }
+
+        const auto [found, block] = block_cache.find( PC);
+        if ( found && is_valid( block, block.instrs.front())) {
+            block_cache.touch( PC);
+            return block;
+        }
+        if ( found)
+            block_cache.erase( PC);
+
+        block_cache.update( PC, decode_block( PC));
+        return block_cache.find( PC).second;
     }
+
+    // Instructions in the block might be overwritten after the block was decoded
+    bool is_valid( const Block& block, const Instr& instr) const
+    {
+        const auto generation = this->get_write_generation( instr.get_PC());
+        if ( generation.has_value() && block.generation.has_value())
+            return *generation <= *block.generation;
+
+        return instr.is_same_bytes( this->fetch( instr.get_PC()));
+    }
+
+    void invalidate_block( Addr PC) { block_cache.erase( PC); }
+
+private:
+    static bool is_cacheable( Addr PC) { return PC != 0 && PC != all_ones<Addr>(); }
+
+    Block decode_block( Addr PC)
+    {
+        Block block;
+        auto& instrs = block.instrs;
+        for ( Addr next = PC; instrs.size() < MAX_BLOCK_SIZE; next = instrs.back().get_new_PC())
+            if ( instrs.emplace_back( InstrMemory<I>::fetch_instr( next)).ends_basic_block())
+                break;
+
+        block.generation = this->get_write_generation( PC);
+        for ( const auto& instr : instrs) {
+            const auto generation = this->get_write_generation( instr.get_PC());
+            if ( !generation.has_value() || !block.generation.has_value()) {
+                block.generation = std::nullopt;
+                break;
+            }
+            block.generation = std::max( *block.generation, *generation);
+        }
+        return block;
+    }
+
+    InstrCache<Addr, Block, BASIC_BLOCK_CACHE_CAPACITY, 0x0, all_ones<Addr>()> block_cache{};
+    Block uncached_block;
 };
 
 #endif // INSTR_CACHE_H
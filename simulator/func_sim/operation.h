@@ -119,6 +119,13 @@ public:
     void set_trap( Trap value) { trap = value; }
     bool is_store() const { return operation == OUT_STORE; }
 
+    // control flow may leave the sequential path after this instruction
+    bool ends_basic_block() const
+    {
+        return is_jump() || is_explicit_trap() || has_trap()
+            || operation == OUT_SYSCALL || operation == OUT_BREAK;
+    }
+
     auto get_mem_addr() const { return mem_addr; }
     auto get_mem_size() const { return mem_size; }
     auto get_PC() const { return PC; }
@@ -24,6 +24,8 @@ class RF
 public:
     RF() = default;
 
+    void reset() { array.fill( RegisterUInt{}); }
+
     const auto& read( Register num) const
     {
         return get_value( num);
@@ -5,9 +5,12 @@
 
 #include <catch.hpp>
 
+#include <func_sim/driver/driver.h>
 #include <func_sim/func_sim.h>
 #include <kernel/kernel.h>
+#include <memory/elf/elf_loader.h>
 #include <memory/memory.h>
+#include <mips/mips.h>
 #include <mips/mips_register/mips_register.h>
 #include <simulator.h>
 
@@ -160,6 +163,55 @@ TEST_CASE( "Run_SMC_trace: Func_Sim")
     CHECK( sim->get_exit_code() == 0);
 }
 
+TEST_CASE( "FuncSim: basic block cache")
+{
+    auto mem = FuncMemory::create_default_hierarchied_memory();
+    ElfLoader elf( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin");
+    elf.load_to( mem.get());
+    BasicBlockCache<MIPS32> cache( std::endian::little);
+    cache.set_memory( mem);
+
+    const auto& block = cache.fetch_block( elf.get_startPC());
+    const auto& instrs = block.instrs;
+    REQUIRE( !instrs.empty());
+    CHECK( block.generation.has_value());
+    CHECK( instrs.front().get_PC() == elf.get_startPC());
+    CHECK( ( instrs.back().ends_basic_block() || instrs.size() == BasicBlockCache<MIPS32>::MAX_BLOCK_SIZE));
+    for ( size_t i = 1; i < instrs.size(); ++i) {
+        CHECK( instrs[i].get_PC() == instrs[i - 1].get_new_PC());
+        CHECK( !instrs[i - 1].ends_basic_block());
+    }
+
+    CHECK( cache.is_valid( block, instrs.back()));
+    mem->write<uint32, std::endian::little>( 0x0, elf.get_startPC());
+    CHECK( !cache.is_valid( block, instrs.back()));
+    CHECK( cache.fetch_block( elf.get_startPC()).instrs.front().is_nop());
+}
+
+TEST_CASE( "FuncSim: decoded instructions cache")
+{
+    ElfLoader elf( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin");
+    for ( const auto& type : { "LRU", "set-associative"}) {
+        auto mem = FuncMemory::create_default_hierarchied_memory();
+        elf.load_to( mem.get());
+        InstrMemoryCached<MIPS32> cache( std::endian::little, { type, 1024, 2});
+        cache.set_memory( mem);
+
+        const auto start_pc = elf.get_startPC();
+        const auto expected = cache.fetch_instr( start_pc);
+        CHECK( cache.get_misses() == 1);
+        CHECK( cache.get_instr( start_pc).get_disasm() == expected.get_disasm());
+        CHECK( cache.get_hits() == 1);
+
+        mem->write<uint32, std::endian::little>( 0x0, start_pc);
+        CHECK( cache.get_instr( start_pc).is_nop());
+        CHECK( cache.get_misses() == 2);
+    }
+
+    CHECK_THROWS_AS( InstrMemoryCached<MIPS32>( std::endian::little, { "FIFO", 1024, 2}), InstrCacheInvalidTypeException);
+    CHECK_THROWS_AS( InstrMemoryCached<MIPS32>( std::endian::little, { "set-associative", 1000, 1}), InstrCacheInvalidSizeException);
+}
+
 TEST_CASE( "Torture_Test: MIPS32 calls without kernel")
 {
     auto system = create_funcsim( "mips32", TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", "default");
@@ -174,6 +226,21 @@ TEST_CASE( "Torture_Test: MIPS32 calls without kernel")
     CHECK( system.sim->get_exit_code() == 0);
 }
 
+TEST_CASE( "Torture_Test: Fast path matches hooked run")
+{
+    auto fast = create_funcsim( "mips32", TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", "default");
+    auto hooked = create_funcsim( "mips32", TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", "gdb");
+
+    for ( int i = 0; i < 50; ++i) {
+        // Hooked driver reports traps, but handles them in the same way
+        fast.sim->run( 1);
+        hooked.sim->run( 1);
+        CHECK( fast.sim->get_pc() == hooked.sim->get_pc());
+        for ( size_t reg = 0; reg < fast.sim->max_cpu_register(); ++reg)
+            CHECK( fast.sim->read_cpu_register( reg) == hooked.sim->read_cpu_register( reg));
+    }
+}
+
 TEST_CASE( "Torture_Test: Stop on trap")
 {
     auto trap = create_funcsim("mips32", TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", "gdb").sim->run( 10000);
@@ -11,6 +11,7 @@
 
 #include <sparsehash/dense_hash_map>
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -22,6 +23,7 @@ class AlwaysHitCacheTagArray : public CacheTagArray
         int32 write( Addr /* unused */) final { return -1; }
         std::pair<bool, int32> read( Addr addr) final { return read_no_touch( addr); }
         std::pair<bool, int32> read_no_touch( Addr /* unused */) const final { return {true, -1}; }
+        void reset() final { }
 };
 
 class InfiniteCacheTagArray : public CacheTagArray
@@ -37,6 +39,11 @@ class InfiniteCacheTagArray : public CacheTagArray
         int32 write( Addr addr) final;
         std::pair<bool, int32> read( Addr addr) final { return read_no_touch( addr); }
         std::pair<bool, int32> read_no_touch( Addr addr) const final;
+        void reset() final
+        {
+            tags.clear();
+            lookup_helper.clear_no_resize();
+        }
     private:
         std::vector<Addr> tags;
 
@@ -154,6 +161,11 @@ class ReplacementModule
     public:
         ReplacementModule( std::size_t number_of_sets, std::size_t number_of_ways, const std::string& replacement_policy);
         void touch( uint32 num_set, uint32 num_way) { replacement_info[ num_set]->touch( num_way); }
+        void reset()
+        {
+            for ( auto& e : replacement_info)
+                e->reset();
+        }
         auto update( uint32 num_set) { return replacement_info[ num_set]->update(); }
 
     private:
@@ -181,6 +193,7 @@ class SimpleCacheTagArray : public CacheTagArraySize
         int32 write( Addr addr) final;
         std::pair<bool, int32> read( Addr addr) final;
         std::pair<bool, int32> read_no_touch( Addr addr) const final;
+        void reset() final;
 
     private:
         static auto create_lookup_helper( int ways)
@@ -219,6 +232,15 @@ SimpleCacheTagArray::SimpleCacheTagArray(
     
 }
 
+void SimpleCacheTagArray::reset()
+{
+    for ( auto& set : tags)
+        std::fill( set.begin(), set.end(), Tag());
+    for ( auto& helper : lookup_helper)
+        helper.clear_no_resize();
+    replacement_module->reset();
+}
+
 std::pair<bool, int32> SimpleCacheTagArray::read( Addr addr)
 {
     const auto lookup_result = read_no_touch( addr);
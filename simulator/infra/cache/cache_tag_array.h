@@ -57,6 +57,9 @@ public:
 
     bool lookup( Addr addr) { return read( addr).first; }; // hit or not
 
+    // Invalidates all lines and replacement information, allocated storage is kept
+    virtual void reset() = 0;
+
     /**
      * Constructor params:
      *
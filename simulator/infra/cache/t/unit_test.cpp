@@ -122,3 +122,21 @@ TEST_CASE( "Check infinite CacheTagArray model with multiple sets")
     for ( Addr i = 0; i < cache_ways + 1; i++)
         CHECK( test_tags->lookup( i * 0x10000000));
 }
+
+TEST_CASE( "CacheTagArray: reset")
+{
+    for ( const std::string type : { "LRU", "pseudo-LRU", "infinite"}) {
+        auto test_tags = CacheTagArray::create( type, cache_size, cache_ways, cache_line_size, addr_size_in_bits);
+        std::vector<int32> ways;
+        for ( Addr i = 0; i < cache_ways; i++)
+            ways.push_back( test_tags->write( i));
+
+        test_tags->reset();
+        for ( Addr i = 0; i < cache_ways; i++)
+            CHECK_FALSE( test_tags->lookup( i));
+
+        // Replacement information is reset as well
+        for ( Addr i = 0; i < cache_ways; i++)
+            CHECK( test_tags->write( i) == ways[i]);
+    }
+}
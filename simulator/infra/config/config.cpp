@@ -7,7 +7,9 @@
 #include <popl.hpp>
 
 #include <cassert>
+#include <charconv>
 #include <iostream>
+#include <set>
 #include <sstream>
 
 namespace config {
@@ -20,6 +22,69 @@ static popl::OptionParser& options()
     return instance;
 }
 
+static std::set<std::string, std::less<>>& option_names()
+{
+    static std::set<std::string, std::less<>> instance;
+    return instance;
+}
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables) Each thread has its own chain of overrides
+static thread_local const ScopedOverrides* current_overrides = nullptr;
+
+ScopedOverrides::ScopedOverrides( Values v) : values( std::move( v)), previous( current_overrides)
+{
+    for ( const auto& entry : values)
+        if ( !option_names().contains( entry.first))
+            throw InvalidOption( "unknown option '" + entry.first + "'");
+    current_overrides = this;
+}
+
+ScopedOverrides::~ScopedOverrides()
+{
+    current_overrides = previous;
+}
+
+const std::string* ScopedOverrides::find( std::string_view name)
+{
+    for ( const auto* scope = current_overrides; scope != nullptr; scope = scope->previous) {
+        const auto it = scope->values.find( name);
+        if ( it != scope->values.end())
+            return &it->second;
+    }
+    return nullptr;
+}
+
+ScopedOverrides::Values ScopedOverrides::get_active()
+{
+    Values result;
+    for ( const auto* scope = current_overrides; scope != nullptr; scope = scope->previous)
+        result.insert( scope->values.begin(), scope->values.end());
+    return result;
+}
+
+template<typename T>
+static T parse_override( const std::string& name, const std::string& text)
+{
+    if constexpr ( std::is_same_v<T, std::string>) {
+        return text;
+    }
+    else if constexpr ( std::is_same_v<T, bool>) {
+        if ( text == "true" || text == "1")
+            return true;
+        if ( text == "false" || text == "0")
+            return false;
+        throw InvalidOption( "'" + text + "' is not a boolean value of '" + name + "'");
+    }
+    else {
+        T result{};
+        const auto* end = text.data() + text.size();
+        const auto [ptr, error] = std::from_chars( text.data(), end, result);
+        if ( error != std::errc() || ptr != end)
+            throw InvalidOption( "'" + text + "' is not a valid value of '" + name + "'");
+        return result;
+    }
+}
+
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays, modernize-avoid-c-arrays, hicpp-avoid-c-arrays)
 void handleArgs( int argc, const char* const argv[], int start_index) try
 {
@@ -43,6 +108,7 @@ static void add_option( std::string_view alias, std::string_view name, std::stri
 {
     (void)default_value;
     (void)predicate;
+    option_names().emplace( name);
     if constexpr ( type == Type::SWITCH)
         options().add<popl::Switch>( std::string( alias), std::string( name), std::string( desc), value);
     else if constexpr ( type == Type::OPTIONAL)
@@ -59,19 +125,33 @@ catch ( const std::exception& e)
 
 template<typename T, Type type>
 BaseTValue<T, type>::BaseTValue( std::string_view alias, std::string_view name, std::string_view desc, const T& default_value, Predicate<T> predicate) noexcept
+    : name( name), predicate( predicate)
 {
     // Workaround for Visual Studio bug
     // https://developercommunity.visualstudio.com/content/problem/846216/false-positive-c4297-for-constructor.html
     add_option<T, type>( alias, name, desc, default_value, predicate, &value);
 }
 
+template<typename T, Type type>
+BaseTValue<T, type>::operator T() const
+{
+    const auto* text = ScopedOverrides::find( name);
+    if ( text == nullptr)
+        return value;
+
+    auto result = parse_override<T>( name, *text);
+    if ( !predicate( result))
+        throw InvalidOption( "'" + *text + "' is not a valid value of '" + name + "'");
+    return result;
+}
+
 template<typename T, Type type>
 std::ostream& BaseTValue<T, type>::dump( std::ostream& out) const
 {
     if constexpr (std::is_same<T, bool>())
-        out << std::boolalpha << value << std::noboolalpha;
+        out << std::boolalpha << T( *this) << std::noboolalpha;
     else
-        out << std::dec << value;
+        out << std::dec << T( *this);
     return out;
 }
 
@@ -9,6 +9,7 @@
 #include <infra/exception.h>
 #include <infra/types.h>
 
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <string>
@@ -38,6 +39,38 @@ static inline Predicate<T> get_null_predicate()
     return [](T /* ignore */){ return true; };
 }
 
+/*
+ * Option values for simulators created by the current thread.
+ * Modules read options in their constructors only, so each simulator keeps
+ * the values which were in effect at its creation, and simulators with
+ * different configurations may be created and run on different threads.
+ * Global values themselves are immutable after handleArgs.
+ */
+class ScopedOverrides
+{
+public:
+    using Values = std::map<std::string, std::string, std::less<>>;
+
+    // Throws InvalidOption if an option does not exist
+    explicit ScopedOverrides( Values values);
+    ~ScopedOverrides();
+
+    ScopedOverrides( const ScopedOverrides&) = delete;
+    ScopedOverrides( ScopedOverrides&&) = delete;
+    ScopedOverrides& operator=( const ScopedOverrides&) = delete;
+    ScopedOverrides& operator=( ScopedOverrides&&) = delete;
+
+    // Searches overrides of the current thread, inner scopes first
+    static const std::string* find( std::string_view name);
+
+    // All overrides of the current thread, e.g. to pass them to another thread
+    static Values get_active();
+
+private:
+    const Values values;
+    const ScopedOverrides* const previous;
+};
+
 template<typename T, Type type>
 class BaseTValue
 {
@@ -46,8 +79,8 @@ public:
 
     // Converter is implicit intentionally, so bypass Clang-Tidy check
     // NOLINTNEXTLINE(hicpp-explicit-conversions, google-explicit-constructor)
-    operator const T&() const { return value; }
-    bool operator==( const T& rhs) const { return value == rhs; }
+    operator T() const;
+    bool operator==( const T& rhs) const { return T( *this) == rhs; }
     bool operator!=( const T& rhs) const { return !operator==(rhs); }
     
     friend std::ostream& operator<<( std::ostream& out, const BaseTValue& rhs)
@@ -66,6 +99,8 @@ private:
     std::ostream& dump( std::ostream& out) const;
 
     T value = T();
+    std::string name;
+    Predicate<T> predicate;
 };
     
 template<typename T>
@@ -13,6 +13,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 namespace config {
     const AliasedRequiredValue<std::string> string_config = { "b", "string_config_name", "string config description"};
@@ -402,3 +403,71 @@ TEST_CASE("MainWrapper: throw integer")
 
     CHECK( Main().run( 0, nullptr) == 3);
 }
+
+TEST_CASE( "config_overrides: scoped values")
+{
+    std::vector<const char*> argv
+    {
+        "mipt-mips",
+        "-b", "file.elf",
+        "-n", "145",
+        nullptr
+    };
+    CHECK_NOTHROW( handleArgs( argv) );
+
+    {
+        const config::ScopedOverrides outer( config::ScopedOverrides::Values{ { "uint64_config_name", "200"}, { "string_config_name", "outer.elf"}});
+        CHECK( config::uint64_config == uint64{ 200});
+        CHECK( config::string_config == "outer.elf");
+        {
+            const config::ScopedOverrides inner( config::ScopedOverrides::Values{ { "uint64_config_name", "300"}, { "bool_config_1", "true"}});
+            CHECK( config::uint64_config == uint64{ 300});
+            CHECK( config::string_config == "outer.elf");
+            CHECK( config::bool_config_1 == true);
+            CHECK( wrap_shift_operator( config::uint64_config) == "300");
+        }
+        CHECK( config::uint64_config == uint64{ 200});
+        CHECK( config::bool_config_1 == false);
+    }
+    CHECK( config::uint64_config == uint64{ 145});
+    CHECK( config::string_config == "file.elf");
+}
+
+TEST_CASE( "config_overrides: other threads")
+{
+    using Values = config::ScopedOverrides::Values;
+    std::vector<const char*> argv
+    {
+        "mipt-mips",
+        "-b", "file.elf",
+        "-n", "145",
+        nullptr
+    };
+    CHECK_NOTHROW( handleArgs( argv) );
+
+    const config::ScopedOverrides overrides( Values{ { "uint64_config_name", "200"}});
+    uint64 value = 0;
+    std::thread thread( [&value]() { value = config::uint64_config; });
+    thread.join();
+    CHECK( value == uint64{ 145});
+    CHECK( config::uint64_config == uint64{ 200});
+}
+
+TEST_CASE( "config_overrides: invalid")
+{
+    using Values = config::ScopedOverrides::Values;
+    CHECK_THROWS_AS( config::ScopedOverrides( Values{ { "no_such_option", "1"}}), config::InvalidOption);
+
+    {
+        const config::ScopedOverrides overrides( Values{ { "uint64_config_name", "many"}});
+        CHECK_THROWS_AS( uint64{ config::uint64_config}, config::InvalidOption);
+    }
+    {
+        const config::ScopedOverrides overrides( Values{ { "bool_config_2", "maybe"}});
+        CHECK_THROWS_AS( bool{ config::bool_config_2}, config::InvalidOption);
+    }
+    {
+        const config::ScopedOverrides overrides( Values{ { "uint64_predicated_config_name", "7"}});
+        CHECK_THROWS_AS( uint64{ config::uint64_predicated_config}, config::InvalidOption);
+    }
+}
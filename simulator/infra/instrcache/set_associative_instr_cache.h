@@ -0,0 +1,130 @@
+/**
+ * A set-associative cache for decoded instructions
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef SET_ASSOCIATIVE_INSTR_CACHE_H
+#define SET_ASSOCIATIVE_INSTR_CACHE_H
+
+#include <infra/exception.h>
+#include <infra/macro.h>
+#include <infra/types.h>
+
+#include <optional>
+#include <vector>
+
+struct InstrCacheInvalidSizeException final : Exception
+{
+    explicit InstrCacheInvalidSizeException(const std::string& msg)
+        : Exception("Invalid instruction cache size", msg)
+    { }
+};
+
+/*
+ * Low-associativity cache indexed by instruction address bits,
+ * a direct-mapped cache is the case of single way.
+ * Each entry keeps a validation stamp (e.g. instruction bytes) next to the tag,
+ * so a stale instruction is detected without touching the decoded value.
+ */
+template <typename Key, typename Value>
+class SetAssociativeInstrCache
+{
+    public:
+        SetAssociativeInstrCache( size_t capacity, size_t ways)
+            : ways( ways)
+            , set_mask( ways == 0 ? 0 : capacity / ways - 1)
+            , entries( capacity)
+            , victims( ways == 0 ? 0 : capacity / ways)
+        {
+            if ( ways == 0)
+                throw InstrCacheInvalidSizeException("Num of ways should be greater than zero");
+
+            if ( capacity < ways || capacity % ways != 0)
+                throw InstrCacheInvalidSizeException("Capacity should be a multiple of the number of ways");
+
+            if ( !is_power_of_two( capacity / ways))
+                throw InstrCacheInvalidSizeException("Number of sets should be a power of 2");
+        }
+
+        auto get_capacity() const { return entries.size(); }
+        auto get_ways() const { return ways; }
+        auto size() const { return occupied; }
+        bool empty() const { return size() == 0; }
+
+        // Returns nullptr if there is no value for the key with the same stamp
+        const Value* find( const Key& key, uint64 stamp) const noexcept
+        {
+            const auto first = get_set( key) * ways;
+            for ( size_t i = first; i < first + ways; ++i) {
+                const auto& e = entries[i];
+                if ( e.value.has_value() && e.key == key && e.stamp == stamp)
+                    return &*e.value;
+            }
+            return nullptr;
+        }
+
+        const Value& update( const Key& key, uint64 stamp, const Value& value)
+        {
+            auto& e = entries[ get_way( key)];
+            if ( !e.value.has_value())
+                ++occupied;
+            e.key = key;
+            e.stamp = stamp;
+            e.value.emplace( value);
+            return *e.value;
+        }
+
+        void erase( const Key& key)
+        {
+            const auto first = get_set( key) * ways;
+            for ( size_t i = first; i < first + ways; ++i) {
+                auto& e = entries[i];
+                if ( e.value.has_value() && e.key == key) {
+                    e.value.reset();
+                    --occupied;
+                }
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            Key key = {};
+            uint64 stamp = 0;
+            std::optional<Value> value;
+        };
+
+        // Keys are instruction addresses, which are aligned to 4 bytes (or to 2 bytes for compressed instructions).
+        // Odd halfwords are spread to the mirrored sets to avoid wasting space on 4-byte ISAs.
+        size_t get_set( const Key& key) const noexcept
+        {
+            const auto index = narrow_cast<size_t>( key >> 2U);
+            return ( ( key & 2U) == 0 ? index : ~index) & set_mask;
+        }
+
+        // Reuses the way holding the same key, otherwise an empty way or the next one in a round-robin order
+        size_t get_way( const Key& key)
+        {
+            const auto set = get_set( key);
+            const auto first = set * ways;
+            for ( size_t i = first; i < first + ways; ++i)
+                if ( entries[i].value.has_value() && entries[i].key == key)
+                    return i;
+
+            for ( size_t i = first; i < first + ways; ++i)
+                if ( !entries[i].value.has_value())
+                    return i;
+
+            auto& victim = victims[set];
+            victim = ( victim + 1) % ways;
+            return first + victim;
+        }
+
+        const size_t ways;
+        const size_t set_mask;
+        std::vector<Entry> entries;
+        std::vector<size_t> victims;
+        size_t occupied = 0;
+};
+
+#endif // SET_ASSOCIATIVE_INSTR_CACHE_H
@@ -7,6 +7,7 @@
 
 // Modules
 #include <infra/instrcache/instr_cache.h>
+#include <infra/instrcache/set_associative_instr_cache.h>
 #include <infra/macro.h>
 #include <infra/types.h>
 
@@ -111,3 +112,76 @@ TEST_CASE( "exceed_capacity_and_test_lru: Add_More_Elements_Than_Capacity_And_Ch
 }
 
 
+
+TEST_CASE( "set_associative: Invalid_Parameters")
+{
+    CHECK_THROWS_AS( ( SetAssociativeInstrCache<Addr, Dummy>( 1024, 0)), InstrCacheInvalidSizeException);
+    CHECK_THROWS_AS( ( SetAssociativeInstrCache<Addr, Dummy>( 1024, 3)), InstrCacheInvalidSizeException);
+    CHECK_THROWS_AS( ( SetAssociativeInstrCache<Addr, Dummy>( 1000, 1)), InstrCacheInvalidSizeException);
+    CHECK_THROWS_AS( ( SetAssociativeInstrCache<Addr, Dummy>( 2, 4)), InstrCacheInvalidSizeException);
+    CHECK_NOTHROW( SetAssociativeInstrCache<Addr, Dummy>( 1024, 1));
+    CHECK_NOTHROW( SetAssociativeInstrCache<Addr, Dummy>( 1024, 4));
+}
+
+TEST_CASE( "set_associative: Update_Find_And_Check_Bytes")
+{
+    SetAssociativeInstrCache<Addr, Dummy> cache( 1024, 1);
+    CHECK( cache.empty());
+
+    const auto& value = cache.update( 0x0, 0x1234, Dummy( 0x1234, 0x0));
+    CHECK( value == Dummy( 0x1234, 0x0));
+    CHECK( cache.size() == 1);
+
+    const auto* result = cache.find( 0x0, 0x1234);
+    CHECK( result == &value);
+    CHECK( cache.find( 0x0, 0x4321) == nullptr);
+    CHECK( cache.find( 0x4, 0x1234) == nullptr);
+
+    cache.erase( 0x0);
+    CHECK( cache.empty());
+    CHECK( cache.find( 0x0, 0x1234) == nullptr);
+}
+
+TEST_CASE( "set_associative: Direct_Mapped_Conflict")
+{
+    SetAssociativeInstrCache<Addr, Dummy> cache( 1024, 1);
+    const Addr conflicting = 0x400000 + 1024 * 4;
+
+    cache.update( 0x400000, 1, Dummy( 1, 0x400000));
+    cache.update( 0x400004, 2, Dummy( 2, 0x400004));
+    cache.update( conflicting, 3, Dummy( 3, conflicting));
+
+    CHECK( cache.size() == 2);
+    CHECK( cache.find( 0x400000, 1) == nullptr);
+    CHECK( cache.find( 0x400004, 2) != nullptr);
+    CHECK( cache.find( conflicting, 3) != nullptr);
+}
+
+TEST_CASE( "set_associative: Ways_Keep_Conflicting_Keys")
+{
+    SetAssociativeInstrCache<Addr, Dummy> cache( 1024, 2);
+    const Addr conflicting = 0x400000 + 512 * 4;
+
+    cache.update( 0x400000, 1, Dummy( 1, 0x400000));
+    cache.update( conflicting, 2, Dummy( 2, conflicting));
+    CHECK( cache.find( 0x400000, 1) != nullptr);
+    CHECK( cache.find( conflicting, 2) != nullptr);
+
+    // Same key reuses its way
+    cache.update( 0x400000, 3, Dummy( 3, 0x400000));
+    CHECK( cache.size() == 2);
+    CHECK( cache.find( 0x400000, 1) == nullptr);
+    CHECK( *cache.find( 0x400000, 3) == Dummy( 3, 0x400000));
+    CHECK( cache.find( conflicting, 2) != nullptr);
+}
+
+TEST_CASE( "set_associative: Halfword_Aligned_Keys")
+{
+    SetAssociativeInstrCache<Addr, Dummy> cache( 16, 1);
+    for ( Addr pc = 0; pc < 32; pc += 2)
+        cache.update( pc, narrow_cast<uint32>( pc), Dummy( pc, pc));
+
+    CHECK( cache.size() == 16);
+    for ( Addr pc = 0; pc < 32; pc += 2)
+        CHECK( cache.find( pc, narrow_cast<uint32>( pc)) != nullptr);
+}
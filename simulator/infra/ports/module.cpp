@@ -11,6 +11,8 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include <algorithm>
+
 namespace pt = boost::property_tree;
 
 Module::Module( Module* parent, std::string name)
@@ -48,6 +50,17 @@ void Module::enable_logging_impl( const std::unordered_set<std::string>& names)
         c->enable_logging_impl( names);
 }
 
+// NOLINTNEXTLINE(misc-no-recursion) Recursive, but must be finite
+bool Module::has_logging() const
+{
+    return sout.enabled() || std::any_of( children.begin(), children.end(), []( const auto& c) { return c->has_logging(); });
+}
+
+bool Module::is_awake( Cycle cycle) const
+{
+    return wakeup_ports.empty() || std::any_of( wakeup_ports.begin(), wakeup_ports.end(), [cycle]( auto* p) { return p->has_data( cycle); });
+}
+
 pt::ptree Module::write_ports_dumping() const
 {
     pt::ptree result;
@@ -20,6 +20,9 @@ class Module : public Log
 public:
     Module( Module* parent, std::string name);
 
+    // Modules without wakeup ports are always awake
+    bool is_awake( Cycle cycle) const;
+
 protected:
     template<typename T>
     auto make_write_port( std::string key, uint32 bandwidth) 
@@ -39,8 +42,25 @@ protected:
         return ptr;
     }
 
+    template<typename T>
+    auto make_write_port( const PortKey<T>& key, uint32 bandwidth)
+    {
+        return make_write_port<T>( std::string( key.name), bandwidth);
+    }
+
+    template<typename T>
+    auto make_read_port( const PortKey<T>& key, Latency latency)
+    {
+        return make_read_port<T>( std::string( key.name), latency);
+    }
+
+    // Clocking the module is a no-op in cycles when none of its wakeup ports has data
+    void add_wakeup_port( BasicReadPort* port) { wakeup_ports.push_back( port); }
+
     void enable_logging_impl( const std::unordered_set<std::string>& names);
     boost::property_tree::ptree topology_dumping_impl() const;
+    // Whether the module or any of its children has logging enabled
+    bool has_logging() const;
 
 private:
     // NOLINTNEXTLINE(misc-no-recursion) Recursive, but must be finite
@@ -62,6 +82,7 @@ private:
     const std::string name;
     std::vector<std::unique_ptr<BasicWritePort>> write_ports;
     std::vector<std::unique_ptr<BasicReadPort>> read_ports;
+    std::vector<BasicReadPort*> wakeup_ports;
 };
 
 class Root : public Module
@@ -74,6 +95,10 @@ public:
 
 protected:
     void init_portmap() { portmap->init(); }
+    // Drops all data in flight, ports may be used from cycle zero again
+    void reset_portmap() { portmap->reset(); }
+    // Cycles before the returned one have no data to read in any port, so modules would do nothing
+    Cycle get_earliest_ready_cycle( Cycle cycle, Cycle limit) const { return portmap->get_earliest_ready_cycle( cycle, limit); }
     void enable_logging( const std::string& values);
     
     void topology_dumping( bool dump, const std::string& filename);
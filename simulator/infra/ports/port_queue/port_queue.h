@@ -29,13 +29,14 @@ class PortQueue
             this->*p = 0;
     }
 
+public:
+    // Arena is kept allocated
     void clear()
     {
         while ( !empty())
             pop();
     }
 
-public:
     PortQueue() = default;
     ~PortQueue()
     {
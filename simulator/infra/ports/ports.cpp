@@ -8,6 +8,8 @@
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <algorithm>
+
 namespace pt = boost::property_tree;
 
 std::shared_ptr<PortMap> PortMap::create_port_map()
@@ -16,8 +18,9 @@ std::shared_ptr<PortMap> PortMap::create_port_map()
     return std::make_shared<PortMapHack>();
 }
 
-void PortMap::init() const
+void PortMap::init()
 {
+    read_ports.clear();
     for ( const auto& cluster : map)
     {
         if ( cluster.second.writer == nullptr)
@@ -26,6 +29,29 @@ void PortMap::init() const
         cluster.second.writer->init( cluster.second.readers);
         for ( const auto& r : cluster.second.readers)
             r->init( cluster.second.writer->get_bandwidth());
+        read_ports.insert( read_ports.end(), cluster.second.readers.begin(), cluster.second.readers.end());
+    }
+}
+
+Cycle PortMap::get_earliest_ready_cycle( Cycle cycle, Cycle limit) const
+{
+    auto result = limit;
+    for ( const auto& r : read_ports) {
+        result = std::min( result, r->get_ready_cycle( cycle));
+        // Nothing can be earlier
+        if ( result <= cycle)
+            break;
+    }
+    return result;
+}
+
+void PortMap::reset() const
+{
+    for ( const auto& cluster : map)
+    {
+        cluster.second.writer->reset();
+        for ( const auto& r : cluster.second.readers)
+            r->reset();
     }
 }
 
@@ -18,6 +18,7 @@
 #include <cassert>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -27,11 +28,22 @@ struct PortError final : Exception {
     { }
 };
 
+// Name of a port bound to the type of its data, so writer and readers of a key cannot disagree on the type
+template<typename T>
+struct PortKey
+{
+    using Type = T;
+    std::string_view name;
+};
+
 class PortMap : public Log
 {
 private:
     static std::shared_ptr<PortMap> create_port_map();
-    void init() const;
+    void init();
+    void reset() const;
+    // The earliest cycle not before the given one when any read port has data, but not later than the limit
+    Cycle get_earliest_ready_cycle( Cycle cycle, Cycle limit) const;
 
     friend class BasicWritePort;
     friend class BasicReadPort;
@@ -49,6 +61,7 @@ private:
     };
 
     std::unordered_map<std::string, Cluster> map = { };
+    std::vector<class BasicReadPort*> read_ports = { };
 };
 
 class Port : public Log
@@ -71,6 +84,7 @@ protected:
         assert( last_cycle <= cycle);
         last_cycle = cycle;
     }
+    void reset_last_cycle() noexcept { last_cycle = 0_cl; }
 
 private:
     const std::shared_ptr<PortMap> pm;
@@ -82,13 +96,39 @@ class BasicReadPort : public Port
 {
 public:
     auto get_latency() const noexcept { return _latency; }
+    // Same as ReadPort<T>::is_ready for users which do not know the type of data
+    bool has_data( Cycle cycle) noexcept
+    {
+        cleanup_stale_data( cycle);
+        return ready_cycle == cycle;
+    }
 
 protected:
     BasicReadPort( const std::shared_ptr<PortMap>& port_map, const std::string& key, Latency latency);
 
+    static constexpr const Cycle NO_DATA = Cycle( MAX_VAL64);
+    // Cycle of the oldest data in the port, the data arrives in order of cycles.
+    // Most ports are empty or wait for later cycles, so their queues are not touched.
+    Cycle ready_cycle = NO_DATA;
+
+    void cleanup_stale_data( Cycle cycle) noexcept
+    {
+        update_last_cycle( cycle);
+        if ( ready_cycle < cycle)
+            drop_stale_data( cycle);
+    }
+
 private:
     friend class PortMap;
     virtual void init( uint32 bandwidth) = 0;
+    virtual void reset() = 0;
+    virtual void drop_stale_data( Cycle cycle) noexcept = 0;
+    // Drops stale data, returns the cycle of the oldest data left in the port or NO_DATA
+    Cycle get_ready_cycle( Cycle cycle) noexcept
+    {
+        cleanup_stale_data( cycle);
+        return ready_cycle;
+    }
     const Latency _latency;
 };
 
@@ -113,6 +153,11 @@ protected:
 private:
     friend class PortMap;
     virtual void init( const std::vector<BasicReadPort*>& readers) = 0;
+    void reset() noexcept
+    {
+        write_counter = 0;
+        reset_last_cycle();
+    }
 
     uint32 write_counter = 0;
     uint32 initialized_bandwidth = 0;
@@ -147,7 +192,9 @@ private:
     void add_reader( BasicReadPort* readers);
     void basic_write( T&& what, Cycle cycle) noexcept( std::is_nothrow_copy_constructible<T>::value);
 
-    std::vector<ReadPort<T>*> destinations = {};
+    // Data is moved to the first reader, so a port with a single reader does not copy anything
+    ReadPort<T>* destination = nullptr;
+    std::vector<ReadPort<T>*> copy_destinations = {};
 };
 
 template<class T> class ReadPort : public BasicReadPort
@@ -157,11 +204,7 @@ public:
         : BasicReadPort( port_map, key, latency)
     { }
 
-    bool is_ready( Cycle cycle) noexcept
-    {
-        cleanup_stale_data( cycle);
-        return !queue.empty() && std::get<Cycle>( queue.front()) == cycle;
-    }
+    bool is_ready( Cycle cycle) noexcept { return has_data( cycle); }
 
     T read( Cycle cycle)
     {
@@ -177,22 +220,35 @@ private:
     {
         Cycle cycle_to_read = cycle + get_latency();
         cleanup_stale_data( cycle);
+        if ( queue.empty())
+            ready_cycle = cycle_to_read;
         queue.emplace( std::move( what), cycle_to_read);
     }
 
-    void cleanup_stale_data( Cycle cycle) noexcept
+    void drop_stale_data( Cycle cycle) noexcept final
     {
-        update_last_cycle( cycle);
-        while ( !queue.empty() && std::get<Cycle>( queue.front()) < cycle)
-           queue.pop();
+        while ( ready_cycle < cycle)
+            pop();
+    }
+
+    void pop() noexcept
+    {
+        queue.pop();
+        ready_cycle = queue.empty() ? NO_DATA : std::get<Cycle>( queue.front());
     }
 
     void init( uint32 bandwidth) final;
+    void reset() final
+    {
+        queue.clear();
+        ready_cycle = NO_DATA;
+        reset_last_cycle();
+    }
 
     T pop_front() noexcept(std::is_nothrow_copy_constructible<T>::value)
     {
         T tmp( std::move( std::get<T>( queue.front())));
-        queue.pop();
+        pop();
         return tmp;
     }
 
@@ -214,18 +270,19 @@ void WritePort<T>::basic_write( T&& what, Cycle cycle)
     noexcept( std::is_nothrow_copy_constructible<T>::value)
 {
     // Copy data to all ports, but move to the first one
-    auto it = std::next( destinations.begin());
-    for ( ; it != destinations.end(); ++it)
-        (*it)->emplaceData( T( what), cycle); // Force copy ctor
+    for ( auto* reader : copy_destinations)
+        reader->emplaceData( T( what), cycle); // Force copy ctor
 
-    destinations.front()->emplaceData( std::move( what), cycle);
+    destination->emplaceData( std::move( what), cycle);
 }
 
 template<class T>
 void WritePort<T>::init( const std::vector<BasicReadPort*>& readers)
 {
     base_init( readers);
-    destinations.reserve( readers.size());
+    destination = nullptr;
+    copy_destinations.clear();
+    copy_destinations.reserve( readers.size() - 1);
     for (const auto& r : readers)
         add_reader( r);
 }
@@ -237,7 +294,10 @@ void WritePort<T>::add_reader( BasicReadPort* reader)
     if ( r == nullptr)
         throw PortError( get_key() + " has type mismatch between write and read ports");
 
-    destinations.emplace_back( r);
+    if ( destination == nullptr)
+        destination = r;
+    else
+        copy_destinations.emplace_back( r);
 }
 
 #endif // PORTS_H
@@ -136,6 +136,91 @@ TEST_CASE("Ports: non-regular read")
     CHECK( pop.rp->read( 2_cl) == 11);
 }
 
+TEST_CASE("Ports: reset")
+{
+    struct TestRoot : public PairOfPorts
+    {
+        void reset() { reset_portmap(); }
+    } pop;
+
+    pop.wp->write( 10, 5_cl);
+    pop.reset();
+
+    // Data in flight is dropped, ports may be used from cycle zero again
+    pop.wp->write( 11, 0_cl);
+    CHECK( pop.rp->read( 1_cl) == 11);
+}
+
+TEST_CASE("Ports: typed keys")
+{
+    static constexpr PortKey<std::string> key = { "Key"};
+    struct TestRoot : public BaseTestRoot
+    {
+        WritePort<std::string>* wp = make_write_port( key, Port::BW);
+        ReadPort<std::string>* rp = make_read_port( key, Port::LATENCY);
+        ReadPort<std::string>* rp_long = make_read_port<std::string>( "Key", Port::LONG_LATENCY);
+        TestRoot() { init_portmap(); }
+    } tr;
+
+    tr.wp->write( std::string( "data"), 0_cl);
+    CHECK( tr.rp->read( 1_cl) == "data");
+    CHECK( tr.rp_long->read( 30_cl) == "data");
+}
+
+TEST_CASE("Ports: earliest ready cycle")
+{
+    struct TestRoot : public BaseTestRoot
+    {
+        ReadPort<int>* rp = make_read_port<int>( "Key", Port::LATENCY);
+        WritePort<int>* wp = make_write_port<int>( "Key", Port::BW);
+        ReadPort<int>* rp_long = make_read_port<int>( "LongKey", Port::LONG_LATENCY);
+        WritePort<int>* wp_long = make_write_port<int>( "LongKey", Port::BW);
+        TestRoot() { init_portmap(); }
+        Cycle get_ready( Cycle cycle) const { return get_earliest_ready_cycle( cycle, 100_cl); }
+    } tr;
+
+    CHECK( tr.get_ready( 0_cl) == 100_cl);
+
+    tr.wp_long->write( 1, 0_cl);
+    tr.wp->write( 2, 0_cl);
+    CHECK( tr.get_ready( 1_cl) == 1_cl);
+    CHECK( tr.rp->read( 1_cl) == 2);
+    CHECK( tr.get_ready( 2_cl) == 30_cl);
+
+    // Data which has not been read in its cycle is dropped
+    tr.wp->write( 3, 2_cl);
+    CHECK( tr.get_ready( 4_cl) == 30_cl);
+    CHECK( tr.get_ready( 31_cl) == 100_cl);
+}
+
+TEST_CASE("Module: wakeup ports")
+{
+    struct TestModule : public Module
+    {
+        ReadPort<int>* rp = make_read_port<int>( "Key", Port::LATENCY);
+        ReadPort<int>* rp_other = make_read_port<int>( "OtherKey", Port::LATENCY);
+        explicit TestModule( Module* parent) : Module( parent, "module") { add_wakeup_port( rp); }
+    };
+    struct TestRoot : public BaseTestRoot
+    {
+        WritePort<int>* wp = make_write_port<int>( "Key", Port::BW);
+        WritePort<int>* wp_other = make_write_port<int>( "OtherKey", Port::BW);
+        TestModule module{ this};
+        TestRoot() { init_portmap(); }
+    } tr;
+
+    CHECK( tr.is_awake( 0_cl));
+    CHECK_FALSE( tr.module.is_awake( 1_cl));
+
+    tr.wp_other->write( 1, 1_cl);
+    CHECK_FALSE( tr.module.is_awake( 2_cl));
+
+    tr.wp->write( 2, 2_cl);
+    CHECK( tr.module.is_awake( 3_cl));
+    CHECK( tr.module.rp->read( 3_cl) == 2);
+    CHECK_FALSE( tr.module.is_awake( 3_cl));
+}
+
 struct SomeHiearchy : public BaseTestRoot
 {
     struct DumpCheckingModule : public Module
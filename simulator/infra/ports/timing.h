@@ -26,6 +26,7 @@ class Cycle
 
         constexpr void inc() { ++value; }
         constexpr explicit operator double() const { return static_cast<double>( value); }
+        constexpr explicit operator uint64() const { return value; }
 
         constexpr uint64 operator%( uint64 number) const { return value % number; }
 
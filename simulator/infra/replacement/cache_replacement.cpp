@@ -7,6 +7,7 @@
 #include "infra/replacement/cache_replacement.h"
 #include "infra/macro.h"
 
+#include <algorithm>
 #include <list>
 #include <vector>
 
@@ -19,6 +20,7 @@ class LRU : public CacheReplacement
         void set_to_erase( std::size_t way) override ;
         std::size_t update() override ;
         std::size_t get_ways() const override { return lru_hash.size(); }
+        void reset() override;
 
     private:
         std::list<std::size_t> lru_list{};
@@ -42,6 +44,12 @@ void LRU::set_to_erase( std::size_t way)
     lru_list.splice( lru_list.end(), lru_list, lru_hash[way]);
 }
 
+void LRU::reset()
+{
+    for ( std::size_t i = 0; i < lru_hash.size(); i++)
+        touch( i);
+}
+
 std::size_t LRU::update()
 {
     // remove the least recently used element from the tail
@@ -60,6 +68,7 @@ class PseudoLRU : public CacheReplacement
         void set_to_erase( std::size_t /* unused */) override;
         std::size_t update() override;
         std::size_t get_ways() const override { return ways; }
+        void reset() override { std::fill( nodes.begin(), nodes.end(), Left); }
 
     private:
         enum Flags { Left = 0, Right = 1};
@@ -32,6 +32,8 @@ public:
     virtual void set_to_erase( std::size_t) = 0;
     virtual std::size_t update() = 0;
     virtual std::size_t get_ways() const = 0;
+    // Returns to the order after construction
+    virtual void reset() = 0;
 };
 
 std::unique_ptr<CacheReplacement> create_cache_replacement( const std::string& name, std::size_t ways);
@@ -0,0 +1,110 @@
+/*
+ * spsc_queue.h - bounded lock-free queue for a single producer and a single consumer
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <infra/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/*
+ * Ring buffer with monotonic head and tail indices.
+ * Each side keeps a cached copy of the other side's index,
+ * so the shared cache lines are touched only when the queue looks full or empty.
+ * Blocking operations spin for a while, then the consumer sleeps on the tail index.
+ */
+template<typename T>
+class SPSCQueue
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit SPSCQueue( size_t capacity)
+        : slots( std::bit_ceil( std::max<size_t>( capacity, 1)))
+        , mask( slots.size() - 1)
+    { }
+
+    size_t get_capacity() const noexcept { return slots.size(); }
+
+    // Producer side
+    bool try_push( T&& value)
+    {
+        const auto tail = back.load( std::memory_order_relaxed);
+        if ( tail - front_cache == slots.size()) {
+            front_cache = front.load( std::memory_order_acquire);
+            if ( tail - front_cache == slots.size())
+                return false;
+        }
+        slots[ tail & mask].emplace( std::move( value));
+        back.store( tail + 1, std::memory_order_seq_cst);
+        if ( is_consumer_sleeping.load( std::memory_order_seq_cst))
+            back.notify_one();
+        return true;
+    }
+
+    void push( T value)
+    {
+        while ( !try_push( std::move( value)))
+            std::this_thread::yield();
+    }
+
+    // Consumer side
+    std::optional<T> try_pop()
+    {
+        const auto head = front.load( std::memory_order_relaxed);
+        if ( head == back_cache) {
+            back_cache = back.load( std::memory_order_acquire);
+            if ( head == back_cache)
+                return std::nullopt;
+        }
+        auto& slot = slots[ head & mask];
+        std::optional<T> value( std::move( slot));
+        slot.reset();
+        front.store( head + 1, std::memory_order_release);
+        return value;
+    }
+
+    T pop()
+    {
+        for ( uint32 spins = 0; ; ++spins) {
+            if ( auto value = try_pop())
+                return std::move( *value);
+            if ( spins < SPINS_BEFORE_SLEEP) {
+                std::this_thread::yield();
+                continue;
+            }
+            // Producer checks the flag after publishing the tail, so either it wakes us or we see the new tail
+            is_consumer_sleeping.store( true, std::memory_order_seq_cst);
+            const auto tail = back.load( std::memory_order_seq_cst);
+            if ( tail == front.load( std::memory_order_relaxed))
+                back.wait( tail, std::memory_order_seq_cst);
+            is_consumer_sleeping.store( false, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static constexpr uint32 SPINS_BEFORE_SLEEP = 64;
+    static constexpr size_t CACHE_LINE = 64;
+
+    // Elements have to be move constructible only
+    std::vector<std::optional<T>> slots;
+    const size_t mask;
+
+    alignas( CACHE_LINE) std::atomic<size_t> back = 0;
+    size_t front_cache = 0; // owned by producer
+
+    alignas( CACHE_LINE) std::atomic<size_t> front = 0;
+    size_t back_cache = 0; // owned by consumer
+
+    // Read by producer on each push, so it does not share a line with often written indices
+    alignas( CACHE_LINE) std::atomic<bool> is_consumer_sleeping = false;
+};
+
+#endif // SPSC_QUEUE_H
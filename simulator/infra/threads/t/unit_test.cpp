@@ -0,0 +1,94 @@
+/*
+ * Unit tests for work-stealing thread pool
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include <catch.hpp>
+
+#include <infra/threads/spsc_queue.h>
+#include <infra/threads/work_stealing_pool.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+TEST_CASE( "WorkStealingPool: run all tasks")
+{
+    WorkStealingPool pool( 4);
+    CHECK( pool.get_threads_count() == 4);
+
+    std::atomic<int> sum = 0;
+    for ( int i = 1; i <= 1000; ++i)
+        pool.submit( [&sum, i]() { sum += i; });
+    pool.wait();
+    CHECK( sum == 500500);
+}
+
+TEST_CASE( "WorkStealingPool: default number of threads")
+{
+    WorkStealingPool pool;
+    CHECK( pool.get_threads_count() > 0);
+    pool.wait();
+}
+
+TEST_CASE( "WorkStealingPool: tasks submit tasks")
+{
+    WorkStealingPool pool( 3);
+    std::atomic<int> count = 0;
+    for ( int i = 0; i < 10; ++i)
+        pool.submit( [&pool, &count]() {
+            for ( int j = 0; j < 10; ++j)
+                pool.submit( [&count]() { ++count; });
+        });
+    pool.wait();
+    CHECK( count == 100);
+}
+
+TEST_CASE( "WorkStealingPool: exception")
+{
+    WorkStealingPool pool( 2);
+    std::atomic<int> count = 0;
+    pool.submit( []() { throw std::runtime_error( "task failed"); });
+    for ( int i = 0; i < 10; ++i)
+        pool.submit( [&count]() { ++count; });
+    CHECK_THROWS_AS( pool.wait(), std::runtime_error);
+    CHECK( count == 10);
+
+    // Pool is usable after the error
+    pool.submit( [&count]() { ++count; });
+    CHECK_NOTHROW( pool.wait());
+    CHECK( count == 11);
+}
+
+TEST_CASE( "SPSCQueue: bounded")
+{
+    SPSCQueue<int> queue( 3);
+    CHECK( queue.get_capacity() == 4);
+    for ( int i = 0; i < 4; ++i)
+        CHECK( queue.try_push( int{ i}));
+    CHECK_FALSE( queue.try_push( 4));
+
+    CHECK( queue.try_pop() == 0);
+    CHECK( queue.try_push( 4));
+    for ( int i = 1; i <= 4; ++i)
+        CHECK( queue.pop() == i);
+    CHECK_FALSE( queue.try_pop().has_value());
+}
+
+TEST_CASE( "SPSCQueue: producer and consumer threads")
+{
+    SPSCQueue<uint64> queue( 16);
+    const uint64 count = 100000;
+    uint64 sum = 0;
+    std::thread consumer( [&queue, &sum]() {
+        for ( uint64 value = queue.pop(); value != 0; value = queue.pop())
+            sum += value;
+    });
+    for ( uint64 i = 1; i <= count; ++i)
+        queue.push( i);
+    // Let the consumer fall asleep
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10));
+    queue.push( 0);
+    consumer.join();
+    CHECK( sum == count * ( count + 1) / 2);
+}
@@ -0,0 +1,115 @@
+/*
+ * work_stealing_pool.cpp - pool of threads with per-thread task queues
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+WorkStealingPool::WorkStealingPool( size_t threads_count)
+{
+    if ( threads_count == 0)
+        threads_count = std::max( 1U, std::thread::hardware_concurrency());
+
+    for ( size_t i = 0; i < threads_count; ++i)
+        queues.emplace_back( std::make_unique<Queue>());
+
+    threads.reserve( threads_count);
+    for ( size_t i = 0; i < threads_count; ++i)
+        threads.emplace_back( [this, i]() { work( i); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::scoped_lock lock( mutex);
+        is_stopping = true;
+    }
+    has_tasks.notify_all();
+    for ( auto& thread : threads)
+        thread.join();
+}
+
+void WorkStealingPool::submit( std::function<void()> task)
+{
+    {
+        // Queue is filled under the pool lock, so a task cannot be taken before it is counted
+        std::scoped_lock lock( mutex);
+        auto& queue = *queues[next_queue];
+        next_queue = ( next_queue + 1) % queues.size();
+        {
+            std::scoped_lock queue_lock( queue.mutex);
+            queue.tasks.emplace_back( std::move( task));
+        }
+        ++queued;
+        ++pending;
+    }
+    has_tasks.notify_one();
+}
+
+bool WorkStealingPool::try_pop( size_t index, std::function<void()>* task)
+{
+    for ( size_t i = 0; i < queues.size(); ++i) {
+        auto& queue = *queues[( index + i) % queues.size()];
+        std::scoped_lock lock( queue.mutex);
+        if ( queue.tasks.empty())
+            continue;
+
+        if ( i == 0) {
+            *task = std::move( queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else {
+            *task = std::move( queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::complete( std::exception_ptr task_error)
+{
+    std::scoped_lock lock( mutex);
+    if ( task_error != nullptr && error == nullptr)
+        error = std::move( task_error);
+    if ( --pending == 0)
+        is_idle.notify_all();
+}
+
+void WorkStealingPool::work( size_t index)
+{
+    while ( true) {
+        std::function<void()> task;
+        if ( try_pop( index, &task)) {
+            {
+                std::scoped_lock lock( mutex);
+                --queued;
+            }
+            std::exception_ptr task_error;
+            try {
+                task();
+            }
+            catch ( ...) {
+                task_error = std::current_exception();
+            }
+            complete( task_error);
+            continue;
+        }
+
+        std::unique_lock lock( mutex);
+        has_tasks.wait( lock, [this]() { return is_stopping || queued != 0; });
+        if ( is_stopping && queued == 0)
+            return;
+    }
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock lock( mutex);
+    is_idle.wait( lock, [this]() { return pending == 0; });
+    if ( error != nullptr)
+        std::rethrow_exception( std::exchange( error, nullptr));
+}
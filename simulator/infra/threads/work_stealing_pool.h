@@ -0,0 +1,67 @@
+/*
+ * work_stealing_pool.h - pool of threads with per-thread task queues
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Each worker takes tasks from the back of its own queue
+ * and steals from the front of other queues when its own one is empty,
+ * so long tasks do not leave other threads idle.
+ */
+class WorkStealingPool
+{
+public:
+    // Zero means the number of host hardware threads
+    explicit WorkStealingPool( size_t threads_count = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool( const WorkStealingPool&) = delete;
+    WorkStealingPool( WorkStealingPool&&) = delete;
+    WorkStealingPool& operator=( const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=( WorkStealingPool&&) = delete;
+
+    // May be called from tasks as well
+    void submit( std::function<void()> task);
+
+    // Blocks until all submitted tasks are completed, rethrows the first exception thrown by a task
+    void wait();
+
+    size_t get_threads_count() const { return threads.size(); }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool try_pop( size_t index, std::function<void()>* task);
+    void work( size_t index);
+    void complete( std::exception_ptr task_error);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable has_tasks;
+    std::condition_variable is_idle;
+    size_t queued = 0;
+    size_t pending = 0;
+    size_t next_queue = 0;
+    bool is_stopping = false;
+    std::exception_ptr error;
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -21,6 +21,7 @@ public:
     void connect_exception_handler() override { }
     void add_replica_simulator( const std::shared_ptr<CPUModel>& s) override { sim->add_replica( s); }
     void add_replica_memory( const std::shared_ptr<FuncMemory>& s) override { mem->add_replica( s); }
+    std::shared_ptr<FuncMemory> create_replica_memory() override { return mem->add_snapshot_replica(); }
     void load_file( const std::string& name) override;
 protected:
     std::unique_ptr<CPUReplicant> sim;
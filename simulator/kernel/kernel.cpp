@@ -24,6 +24,17 @@ void BaseKernel::load_file( const std::string& name)
     start_pc = loader.get_startPC();
 }
 
+void Kernel::save_state( std::ostream& out) const
+{
+    out << exit_code << ' ' << start_pc << '\n';
+}
+
+void Kernel::restore_state( std::istream& in)
+{
+    if ( !( in >> exit_code >> start_pc))
+        throw BadKernelState( "no exit code and start PC");
+}
+
 class DummyKernel : public BaseKernel
 {
 public:
@@ -42,7 +53,17 @@ std::shared_ptr<Kernel> Kernel::create_kernel( bool is_mars, std::istream& cin,
 std::shared_ptr<Kernel> Kernel::create_configured_kernel()
 {
     // NOLINTNEXTLINE(clang-analyzer-cplusplus.NewDeleteLeaks) https://github.com/llvm/llvm-project/issues/44859
-    return Kernel::create_kernel( config::use_mars, std::cin, std::cout, std::cerr);
+    return create_configured_kernel( std::cin, std::cout, std::cerr);
+}
+
+std::shared_ptr<Kernel> Kernel::create_configured_kernel( std::istream& cin, std::ostream& cout, std::ostream& cerr)
+{
+    return Kernel::create_kernel( config::use_mars, cin, cout, cerr);
+}
+
+bool Kernel::is_mars_configured()
+{
+    return config::use_mars;
 }
 
 Trap Kernel::execute_interactive()
@@ -19,6 +19,10 @@ struct BadInputValue final : Exception {
     explicit BadInputValue( const std::string& msg) : Exception( "Bad input value", msg) {}
 };
 
+struct BadKernelState final : Exception {
+    explicit BadKernelState( const std::string& msg) : Exception( "Bad kernel state", msg) {}
+};
+
 struct BadInteraction final : Exception {
     BadInteraction() : Exception( "Too may unsuccessful system call attempts, aborting") {}
 };
@@ -31,15 +35,23 @@ public:
     explicit Kernel( std::ostream& cerr) : cerr( cerr) { }
 
     static std::shared_ptr<Kernel> create_configured_kernel();
+    static std::shared_ptr<Kernel> create_configured_kernel( std::istream& cin, std::ostream& cout, std::ostream& cerr);
     static std::shared_ptr<Kernel> create_kernel( bool is_mars, std::istream& cin, std::ostream& cout, std::ostream& cerr);
+    static bool is_mars_configured();
 
     virtual void set_simulator( const std::shared_ptr<CPUModel>& s) = 0;
     virtual void connect_memory( std::shared_ptr<FuncMemory> m) = 0;
     virtual void connect_exception_handler() = 0;
     virtual void add_replica_simulator( const std::shared_ptr<CPUModel>& s) = 0;
     virtual void add_replica_memory( const std::shared_ptr<FuncMemory>& s) = 0;
+    // Snapshots the connected memory and adds the snapshot as a replica
+    virtual std::shared_ptr<FuncMemory> create_replica_memory() = 0;
     virtual void load_file( const std::string& name) = 0;
 
+    // State which is kept outside of guest registers and memory, e.g. open files
+    virtual void save_state( std::ostream& out) const;
+    virtual void restore_state( std::istream& in);
+
     virtual Trap execute() = 0;
     Trap execute_interactive();
     void handle_instruction( Operation* instr);
@@ -11,6 +11,7 @@
 #include <memory/elf/elf_loader.h>
 
 #include <fstream>
+#include <iomanip>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -37,7 +38,15 @@ class MARSKernel : public BaseKernel {
     std::ostream& outstream;
     std::ostream& errstream;
 
-    std::unordered_map<uint64, std::fstream> files;
+    struct OpenFile
+    {
+        std::string name;
+        uint64 flags = 0;
+        // Position is queried on checkpointing, which does not change the file
+        mutable std::fstream stream;
+    };
+
+    std::unordered_map<uint64, OpenFile> files;
     static const constexpr uint64 first_user_descriptor = 3;
     uint64 next_descriptor = first_user_descriptor;
 
@@ -47,6 +56,8 @@ class MARSKernel : public BaseKernel {
 public:
     Trap execute() final;
     void connect_exception_handler() final;
+    void save_state( std::ostream& out) const final;
+    void restore_state( std::istream& in) final;
 
     MARSKernel( std::istream& instream, std::ostream& outstream, std::ostream& errstream)
       : BaseKernel( errstream), instream( instream), outstream( outstream), errstream( errstream) {}
@@ -142,6 +153,11 @@ static auto get_openmode( uint64 value) {
     }
 }
 
+// Files opened for writing are not truncated again
+static auto get_reopen_mode( uint64 value) {
+    return value == 1 ? std::ios_base::in | std::ios_base::out | std::ios_base::binary : get_openmode( value);
+}
+
 void MARSKernel::io_failure()
 {
     sim->write_cpu_register( v0, all_ones<uint64>());
@@ -157,7 +173,7 @@ void MARSKernel::open_file() {
         return;
     }
 
-    files.emplace( next_descriptor, std::move( file));
+    files.emplace( next_descriptor, OpenFile{ filename, flags, std::move( file)});
     sim->write_cpu_register( v0, next_descriptor);
     ++next_descriptor;
 }
@@ -174,9 +190,45 @@ void MARSKernel::close_file() {
     files.erase( it);
 }
 
+void MARSKernel::save_state( std::ostream& out) const {
+    Kernel::save_state( out);
+    out << next_descriptor << ' ' << files.size() << '\n';
+    for ( const auto& [descriptor, file] : files) {
+        file.stream.flush();
+        const std::streamoff position = file.flags == 0 ? file.stream.tellg() : file.stream.tellp();
+        out << descriptor << ' ' << file.flags << ' ' << position << ' ' << std::quoted( file.name) << '\n';
+    }
+}
+
+void MARSKernel::restore_state( std::istream& in) {
+    Kernel::restore_state( in);
+    size_t count = 0;
+    if ( !( in >> next_descriptor >> count))
+        throw BadKernelState( "no MARS file descriptors");
+
+    files.clear();
+    for ( size_t i = 0; i < count; ++i) {
+        uint64 descriptor = 0;
+        OpenFile file;
+        std::streamoff position = 0;
+        if ( !( in >> descriptor >> file.flags >> position >> std::quoted( file.name)))
+            throw BadKernelState( "bad MARS file descriptor");
+
+        file.stream.open( file.name, get_reopen_mode( file.flags));
+        if ( !file.stream.is_open())
+            throw BadKernelState( "cannot reopen " + file.name);
+
+        if ( file.flags == 0)
+            file.stream.seekg( position);
+        else
+            file.stream.seekp( position);
+        files.emplace( descriptor, std::move( file));
+    }
+}
+
 std::fstream* MARSKernel::find_user_file_by_descriptor(uint64 descriptor) {
     auto it = files.find( descriptor);
-    return it == files.end() ? nullptr : &(it->second);
+    return it == files.end() ? nullptr : &(it->second.stream);
 }
 
 std::istream* MARSKernel::find_in_file_by_descriptor(uint64 descriptor) {
@@ -250,7 +302,7 @@ void MARSKernel::connect_mars_handler()
 
 static bool is_mips_le( std::string_view isa)
 {
-    static std::unordered_set<std::string_view> isas =
+    static const std::unordered_set<std::string_view> isas =
         { "mars", "mars64", "mips32le", "mips32", "mips64", "mips64le" };
     return isas.contains( isa);
 }
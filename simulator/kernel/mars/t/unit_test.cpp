@@ -351,6 +351,50 @@ TEST_CASE( "MARS: open, read and close a file")
     CHECK( trap == Trap::NO_TRAP);
 }
 
+TEST_CASE( "MARS: restore open file from saved state")
+{
+    std::string filename("tempfile");
+    std::ostringstream output;
+    std::ostringstream err;
+    std::stringstream state;
+    uint64 descriptor = 0;
+    {
+        MARSSystem sys( std::cin, output, err);
+        sys.mem->write_string( filename, 0x1000);
+        sys.mem->write_string( "Lorem Ipsum\n", 0x2000);
+
+        CHECK( open_file( &sys, 0x1000, 1) == Trap::NO_TRAP); // WRONLY
+        descriptor = sys.sim->read_cpu_register( v0);
+        CHECK( write_buff_to_file( &sys, descriptor, 0x2000, 6) == Trap::NO_TRAP);
+        sys.mars_kernel->save_state( state);
+    }
+
+    MARSSystem sys( std::cin, output, err);
+    sys.mars_kernel->restore_state( state);
+    sys.mem->write_string( filename, 0x1000);
+    sys.mem->write_string( "Lorem Ipsum\n", 0x2000);
+    CHECK( write_buff_to_file( &sys, descriptor, 0x2006, 5) == Trap::NO_TRAP);
+    CHECK( close_file( &sys, descriptor) == Trap::NO_TRAP);
+
+    CHECK( open_file( &sys, 0x1000, 0) == Trap::NO_TRAP); // read
+    CHECK( sys.sim->read_cpu_register( v0) == descriptor + 1);
+    CHECK( read_from_file( &sys, descriptor + 1, 0x3000, 11) == Trap::NO_TRAP);
+    CHECK( sys.mem->read_string( 0x3000) == "Lorem Ipsum");
+}
+
+TEST_CASE( "MARS: restore bad state")
+{
+    auto sim = Simulator::create_simulator( "mips64", true);
+    auto mars_kernel = create_mars_kernel( std::cin, std::cout, std::cerr);
+    mars_kernel->set_simulator( sim);
+
+    std::istringstream no_descriptors( "0 0\n");
+    CHECK_THROWS_AS( mars_kernel->restore_state( no_descriptors), BadKernelState);
+
+    std::istringstream missing_file( "0 0\n4 1\n3 0 0 \"/ksagklhfgldg/sgsfgdsfgadg\"\n");
+    CHECK_THROWS_AS( mars_kernel->restore_state( missing_file), BadKernelState);
+}
+
 TEST_CASE( "MARS: open file with invalid mode")
 {
     std::string filename("tempfile");
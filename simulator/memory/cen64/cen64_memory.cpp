@@ -49,6 +49,9 @@ public:
         throw CEN64MemoryUnsupportedInterface("string output");
     }
 
+    // CEN64 writes to the bus bypassing this interface
+    const uint64* get_page_generation( Addr /* addr */) const final { return nullptr; }
+
 private:
     bus_controller* const bus = nullptr;
 
@@ -14,6 +14,7 @@
 // Generic C++
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -50,14 +51,25 @@ class HierarchiedMemoryArgumentChecker
 // NOLINTNEXTLINE(fuchsia-multiple-inheritance)
 class HierarchiedMemory : public FuncMemory, private HierarchiedMemoryArgumentChecker
 {
+    private:
+        // Tables and pages are shared between snapshots and copied on the first write
+        using Page = std::vector<std::byte>;
+        using Set  = std::vector<std::shared_ptr<Page>>;
+        using Mem  = std::vector<std::shared_ptr<Set>>;
+
     public:
-        HierarchiedMemory ( uint32 addr_bits, uint32 page_bits, uint32 offset_bits);
+        HierarchiedMemory ( uint32 addr_bits, uint32 page_bits, uint32 offset_bits, std::shared_ptr<Mem> shared = nullptr);
 
         std::string dump() const final;
         size_t memcpy_host_to_guest( Addr dst, const std::byte* src, size_t size) final;
         size_t memcpy_guest_to_host( std::byte* dst, Addr src, size_t size) const noexcept final;
         size_t strlen( Addr addr) const final;
         void duplicate_to( std::shared_ptr<WriteableMemory> target) const final;
+        std::shared_ptr<FuncMemory> snapshot() const final;
+
+    protected:
+        const std::byte* get_host_read_pointer( Addr addr) const noexcept final;
+        std::byte* get_host_data( Addr addr) noexcept final;
 
     private:
         const Addr addr_mask;
@@ -69,27 +81,26 @@ class HierarchiedMemory : public FuncMemory, private HierarchiedMemoryArgumentCh
         const size_t set_cnt;
         const size_t page_size;
 
-        using Page = std::vector<std::byte>;
-        using Set  = std::vector<Page>;
-        using Mem  = std::vector<Set>;
-        Mem memory = {};
+        std::shared_ptr<Mem> memory;
 
         size_t get_set( Addr addr) const noexcept;
         size_t get_page( Addr addr) const noexcept;
         size_t get_offset( Addr addr) const noexcept;
 
         Addr get_addr( Addr set, Addr page, Addr offset) const noexcept;
-        Addr get_addr(const Mem::const_iterator& set_it,
-                      const Set::const_iterator& page_it,
-                      const Page::const_iterator& byte_it) const noexcept;
+
+        // Calls the visitor for each allocated page
+        template<typename Visitor> void for_each_page( Visitor visitor) const;
+
+        // Bytes from the address to the end of its page
+        size_t get_chunk_size( Addr addr) const noexcept;
 
         bool check( Addr addr) const noexcept;
-        std::byte read_byte( Addr addr) const noexcept;
-        std::byte check_and_read_byte( Addr addr) const noexcept;
+        bool is_owned( Addr addr) const noexcept;
+        const std::byte* get_page_data( Addr addr) const noexcept;
 
-        void alloc( Addr addr);
-        void write_byte( Addr addr, std::byte value);
-        void alloc_and_write_byte( Addr addr, std::byte value);
+        // Returns the beginning of the allocated page which is not shared with snapshots
+        std::byte* alloc( Addr addr);
 };
 
 std::shared_ptr<FuncMemory>
@@ -100,7 +111,8 @@ FuncMemory::create_hierarchied_memory( uint32 addr_bits, uint32 page_bits, uint3
 
 HierarchiedMemory::HierarchiedMemory( uint32 addr_bits,
                         uint32 page_bits,
-                        uint32 offset_bits) :
+                        uint32 offset_bits,
+                        std::shared_ptr<Mem> shared) :
     HierarchiedMemoryArgumentChecker( addr_bits, page_bits, offset_bits),
     addr_mask( bitmask<Addr>( std::min<uint32>( addr_bits, bitwidth<Addr>))),
     offset_mask( bitmask<Addr>( offset_bits)),
@@ -108,9 +120,34 @@ HierarchiedMemory::HierarchiedMemory( uint32 addr_bits,
     set_mask ( bitmask<Addr>( set_bits) << ( page_bits + offset_bits)),
     page_cnt ( 1ULL << page_bits ),
     set_cnt ( 1ULL << set_bits ),
-    page_size ( 1ULL << offset_bits)
+    page_size ( 1ULL << offset_bits),
+    memory( shared != nullptr ? std::move( shared) : std::make_shared<Mem>( set_cnt))
+{
+    // Pages are moved only if they are copied from snapshots
+    enable_tlb( offset_bits);
+}
+
+std::shared_ptr<FuncMemory> HierarchiedMemory::snapshot() const
+{
+    // Pages are shared now, so writes must go through copying
+    flush_tlb();
+    return std::make_shared<HierarchiedMemory>( page_bits + offset_bits + set_bits, page_bits, offset_bits, memory);
+}
+
+const std::byte* HierarchiedMemory::get_host_read_pointer( Addr addr) const noexcept
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+    return check( addr) ? get_page_data( addr) + get_offset( addr) : nullptr;
+}
+
+std::byte* HierarchiedMemory::get_host_data( Addr addr) noexcept
 {
-    memory.resize(set_cnt);
+    // Out of range writes have to throw, shared pages have to be copied
+    if ( addr > addr_mask || !check( addr) || !is_owned( addr))
+        return nullptr;
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+    return (*(*memory)[get_set(addr)])[get_page(addr)]->data() + get_offset( addr);
 }
 
 size_t HierarchiedMemory::memcpy_host_to_guest( Addr dst, const std::byte* src, size_t size)
@@ -124,52 +161,94 @@ size_t HierarchiedMemory::memcpy_host_to_guest( Addr dst, const std::byte* src,
     if (dst > addr_mask + 1 - size)
         throw FuncMemoryOutOfRange( dst, addr_mask + 1);
 
+    count_write( dst, size);
     size_t offset = 0;
-    for (; offset < size; ++offset)
+    while ( offset < size) {
+        const Addr addr = dst + offset;
+        const size_t chunk = std::min<size_t>( size - offset, get_chunk_size( addr));
         // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
-        alloc_and_write_byte( dst + offset, src[offset]);
+        std::memcpy( alloc( addr) + get_offset( addr), src + offset, chunk);
+        offset += chunk;
+    }
     return offset;
 }
 
 size_t HierarchiedMemory::memcpy_guest_to_host( std::byte *dst, Addr src, size_t size) const noexcept
 {
     size_t offset = 0;
-    for (; offset < size; ++offset)
+    while ( offset < size) {
+        const Addr addr = src + offset;
+        const size_t chunk = std::min<size_t>( size - offset, get_chunk_size( addr));
         // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
-        dst[offset] = check_and_read_byte( src + offset);
+        auto* const host = dst + offset;
+        if ( check( addr))
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+            std::memcpy( host, get_page_data( addr) + get_offset( addr), chunk);
+        else
+            std::fill_n( host, chunk, std::byte{});
+        offset += chunk;
+    }
     return offset;
 }
 
-void HierarchiedMemory::alloc_and_write_byte( Addr addr, std::byte value)
+template<typename T>
+static void copy_if_shared( std::shared_ptr<T>* ptr)
 {
-    alloc( addr);
-    write_byte( addr, value);
+    if ( ptr->use_count() > 1)
+        *ptr = std::make_shared<T>( **ptr);
 }
 
-void HierarchiedMemory::alloc( Addr addr)
+std::byte* HierarchiedMemory::alloc( Addr addr)
 {
-    auto& set = memory[get_set(addr)];
-    if ( set.empty())
-        set.resize(page_cnt);
-
-    auto& page = set[get_page(addr)];
-    if ( page.empty())
-        page.resize(page_size, std::byte());
+    copy_if_shared( &memory);
+    auto& set = (*memory)[get_set(addr)];
+    if ( set == nullptr)
+        set = std::make_shared<Set>( page_cnt);
+    else
+        copy_if_shared( &set);
+
+    auto& page = (*set)[get_page(addr)];
+    if ( page == nullptr) {
+        page = std::make_shared<Page>( page_size, std::byte());
+    }
+    else if ( page.use_count() > 1) {
+        page = std::make_shared<Page>( *page);
+        // Cached pointers lead to the page of the snapshot
+        flush_tlb();
+    }
+
+    return page->data();
 }
 
 bool HierarchiedMemory::check( Addr addr) const noexcept
 {
-    const auto& set = memory[get_set(addr)];
-    return !set.empty() && !set[get_page(addr)].empty();
+    const auto& set = (*memory)[get_set(addr)];
+    return set != nullptr && (*set)[get_page(addr)] != nullptr;
+}
+
+bool HierarchiedMemory::is_owned( Addr addr) const noexcept
+{
+    const auto& set = (*memory)[get_set(addr)];
+    return memory.use_count() == 1 && set.use_count() == 1 && (*set)[get_page(addr)].use_count() == 1;
+}
+
+template<typename Visitor>
+void HierarchiedMemory::for_each_page( Visitor visitor) const
+{
+    for ( size_t set = 0; set < set_cnt; ++set) {
+        const auto& set_ptr = (*memory)[set];
+        if ( set_ptr != nullptr)
+            for ( size_t page = 0; page < page_cnt; ++page)
+                if ( (*set_ptr)[page] != nullptr)
+                    visitor( get_addr( set, page, 0), *(*set_ptr)[page]);
+    }
 }
 
 void HierarchiedMemory::duplicate_to( std::shared_ptr<WriteableMemory> target) const
 {
-    for ( auto set_it = memory.begin(); set_it != memory.end(); ++set_it)
-        for ( auto page_it = set_it->begin(); page_it != set_it->end(); ++page_it)
-            target->memcpy_host_to_guest( get_addr( set_it, page_it, page_it->begin()),
-                                          page_it->data(),
-                                          page_it->size());
+    for_each_page( [&target]( Addr addr, const Page& page) {
+        target->memcpy_host_to_guest( addr, page.data(), page.size());
+    });
 }
 
 std::string HierarchiedMemory::dump() const
@@ -177,23 +256,16 @@ std::string HierarchiedMemory::dump() const
     std::ostringstream oss;
     oss << std::setfill( '0') << std::hex;
 
-    for ( auto set_it = memory.begin(); set_it != memory.end(); ++set_it)
-        for ( auto page_it = set_it->begin(); page_it != set_it->end(); ++page_it)
-            for ( auto byte_it = page_it->begin(); byte_it != page_it->end(); ++byte_it)
-                if ( uint32( *byte_it) != 0)
-                    oss << "addr 0x" << get_addr( set_it, page_it, byte_it)
-                        << ": data 0x" << uint32( *byte_it) << std::endl;
+    for_each_page( [&oss]( Addr addr, const Page& page) {
+        for ( size_t i = 0; i < page.size(); ++i)
+            if ( uint32( page[i]) != 0)
+                oss << "addr 0x" << addr + i
+                    << ": data 0x" << uint32( page[i]) << std::endl;
+    });
 
     return std::move( oss).str();
 }
 
-Addr HierarchiedMemory::get_addr(const Mem::const_iterator& set_it, const Set::const_iterator& page_it, const Page::const_iterator& byte_it) const noexcept
-{
-    return get_addr( std::distance( memory.begin(), set_it),
-                     std::distance( set_it->begin(), page_it),
-                     std::distance( page_it->begin(), byte_it));
-}
-
 inline size_t HierarchiedMemory::get_set( Addr addr) const noexcept
 {
     return ( addr & set_mask) >> ( page_bits + offset_bits);
@@ -214,26 +286,34 @@ inline Addr HierarchiedMemory::get_addr( Addr set, Addr page, Addr offset) const
     return (set << (page_bits + offset_bits)) | (page << offset_bits) | offset;
 }
 
-inline std::byte HierarchiedMemory::read_byte( Addr addr) const noexcept
-{
-    return memory[get_set(addr)][get_page(addr)][get_offset(addr)];
-}
-
-std::byte HierarchiedMemory::check_and_read_byte( Addr addr) const noexcept
+inline size_t HierarchiedMemory::get_chunk_size( Addr addr) const noexcept
 {
-    return check( addr) ? read_byte( addr) : std::byte{};
+    return page_size - get_offset( addr);
 }
 
-inline void HierarchiedMemory::write_byte( Addr addr, std::byte value)
+inline const std::byte* HierarchiedMemory::get_page_data( Addr addr) const noexcept
 {
-    memory[get_set(addr)][get_page(addr)][get_offset(addr)] = value;
+    return (*(*memory)[get_set(addr)])[get_page(addr)]->data();
 }
 
 size_t HierarchiedMemory::strlen( Addr addr) const
 {
-    for (size_t i = 0; i <= addr_mask; ++i)
-        if ( check_and_read_byte( addr + i) == std::byte{})
-            return i;
+    size_t length = 0;
+    while ( length <= addr_mask) {
+        const Addr current = addr + length;
+        // Written that way to avoid overflow if the whole 64-bit space is addressed
+        const size_t chunk = std::min<size_t>( get_chunk_size( current) - 1, addr_mask - length) + 1;
+        if ( !check( current))
+            return length;
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+        const auto* begin = get_page_data( current) + get_offset( current);
+        const auto* zero = static_cast<const std::byte*>( std::memchr( begin, 0, chunk));
+        if ( zero != nullptr)
+            return length + std::distance( begin, zero);
+
+        length += chunk;
+    }
 
     return addr_mask + 1;
 }
@@ -4,12 +4,19 @@
  * Copyright 2012-2018 uArchSim iLab project
  */
 
+#include <infra/config/config.h>
 #include <infra/uint128.h>
 #include <memory/memory.h>
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
 #include <vector>
 
+namespace config {
+    static const Value<std::string> memory_type = { "memory-type", "hierarchied", "Type of guest memory (hierarchied, mmap)"};
+} // namespace config
+
 FuncMemoryBadMapping::FuncMemoryBadMapping( const std::string& msg) :
     Exception( "Invalid FuncMemory mapping", msg)
 { }
@@ -93,8 +100,10 @@ void WriteableMemory::write_string_by_size( const std::string& value, Addr addr,
 
 void WriteableMemory::memset( Addr addr, std::byte value, size_t size)
 {
-    for ( size_t i = 0; i < size; ++i)
-    	memcpy_host_to_guest( addr + i, &value, 1);
+    static const constexpr size_t CHUNK_SIZE = 4096;
+    const std::vector<std::byte> chunk( std::min( size, CHUNK_SIZE), value);
+    for ( size_t offset = 0; offset < size; offset += chunk.size())
+        memcpy_host_to_guest( addr + offset, chunk.data(), std::min( size - offset, chunk.size()));
 }
 
 template<Unsigned T, std::endian endian> void
@@ -128,3 +137,74 @@ ReadableAndWriteableMemory::~ReadableAndWriteableMemory() = default;
 FuncMemory::FuncMemory() = default;
 FuncMemory::~FuncMemory() = default;
 
+std::shared_ptr<FuncMemory> FuncMemory::create_configured_memory()
+{
+    if ( config::memory_type == "hierarchied")
+        return create_default_hierarchied_memory();
+
+    if ( config::memory_type == "mmap")
+        return create_default_mmap_memory();
+
+    throw FuncMemoryBadMapping( "Unknown memory type: " + std::string( config::memory_type));
+}
+
+std::shared_ptr<FuncMemory> FuncMemory::snapshot() const
+{
+    auto result = create_default_hierarchied_memory();
+    duplicate_to( result);
+    return result;
+}
+
+
+// Generations start above 32-bit range, so they never match an instruction word
+static std::atomic<uint64> next_page_generation = 1ULL << 32U;
+
+const uint64* FuncMemory::get_page_generation( Addr addr) const
+{
+    const Addr page = addr >> GENERATION_PAGE_BITS;
+    auto [it, inserted] = page_generations.try_emplace( page, 0);
+    if ( inserted) {
+        it->second = next_page_generation++;
+        lowest_tracked_page = std::min( lowest_tracked_page, page);
+        highest_tracked_page = std::max( highest_tracked_page, page);
+        // Further writes to the page must be counted
+        write_tlb.flush();
+    }
+    return &it->second;
+}
+
+void FuncMemory::count_write( Addr addr, size_t size) noexcept
+{
+    if ( size == 0)
+        return;
+
+    const Addr first = std::max( addr >> GENERATION_PAGE_BITS, lowest_tracked_page);
+    const Addr last = std::min( ( addr + size - 1) >> GENERATION_PAGE_BITS, highest_tracked_page);
+    for ( Addr page = first; page <= last; ++page) {
+        auto it = page_generations.find( page);
+        if ( it != page_generations.end())
+            it->second = next_page_generation++;
+    }
+}
+
+void FuncMemory::enable_tlb( uint32 page_bits) noexcept
+{
+    // TLB pages must not exceed generation pages, so pages with counted writes are never translated
+    const auto bits = std::min( page_bits, GENERATION_PAGE_BITS);
+    read_tlb.enable( bits);
+    write_tlb.enable( bits);
+}
+
+void FuncMemory::flush_tlb() const noexcept
+{
+    read_tlb.flush();
+    write_tlb.flush();
+}
+
+std::byte* FuncMemory::get_host_write_pointer( Addr addr) noexcept
+{
+    if ( page_generations.contains( addr >> GENERATION_PAGE_BITS))
+        return nullptr;
+
+    return get_host_data( addr);
+}
@@ -13,11 +13,14 @@
 #include <infra/exception.h>
 #include <infra/macro.h>
 #include <infra/types.h>
+#include <memory/software_tlb.h>
 
 #include <array>
 #include <cassert>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 struct FuncMemoryBadMapping final : Exception
@@ -60,6 +63,14 @@ public:
     virtual void duplicate_to( std::shared_ptr<WriteableMemory> target) const = 0;
     virtual std::string dump() const = 0;
     virtual size_t strlen( Addr addr) const = 0;
+
+    // Writes are counted per page of 2 ** GENERATION_PAGE_BITS bytes
+    static constexpr uint32 GENERATION_PAGE_BITS = 12;
+
+    // Returns a pointer to the generation of the page holding the address, or nullptr if writes are not counted.
+    // Generation grows on each write to the page and is unique among all pages of all memories.
+    virtual const uint64* get_page_generation( Addr /* addr */) const { return nullptr; }
+
     std::string read_string( Addr addr) const;
     std::string read_string_limited( Addr addr, size_t size) const;
 
@@ -67,6 +78,10 @@ public:
     template<Unsigned T, std::endian endian> T read( Addr addr, T mask) const noexcept { return read<T, endian>( addr) & mask; }
 protected:
     template<typename Instr> void load( Instr* instr) const;
+
+    // Host memory of the TLB page starting at the address, nullptr if the page cannot be read directly
+    virtual const std::byte* get_host_read_pointer( Addr /* addr */) const noexcept { return nullptr; }
+    mutable SoftwareTLB<const std::byte*> read_tlb;
 private:
     std::string read_string_by_size( Addr addr, size_t size) const;
 };
@@ -76,7 +91,11 @@ T ReadableMemory::read( Addr addr) const noexcept
 {
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init, hicpp-member-init) Initialized by memcpy
     std::array<std::byte, bytewidth<T>> bytes;
-    memcpy_guest_to_host( bytes.data(), addr, bytes.size());
+    const auto* host = read_tlb.translate( addr, bytes.size(), [this]( Addr page) { return get_host_read_pointer( page); });
+    if ( host != nullptr)
+        std::memcpy( bytes.data(), host, bytes.size());
+    else
+        memcpy_guest_to_host( bytes.data(), addr, bytes.size());
     return pack_array<endian>( bytes);
 }
 
@@ -116,7 +135,11 @@ public:
     void write( T value, Addr addr)
     {
         const auto& bytes = unpack_array<endian>( value);
-        memcpy_host_to_guest( addr, bytes.data(), bytes.size());
+        auto* host = write_tlb.translate( addr, bytes.size(), [this]( Addr page) { return get_host_write_pointer( page); });
+        if ( host != nullptr)
+            std::memcpy( host, bytes.data(), bytes.size());
+        else
+            memcpy_host_to_guest( addr, bytes.data(), bytes.size());
     }
 
     template<Unsigned T, std::endian endian>
@@ -126,6 +149,10 @@ public:
     void write_string_limited( const std::string& value, Addr addr, size_t size);
 
     void memset( Addr addr, std::byte value, size_t size);
+protected:
+    // Host memory of the TLB page starting at the address, nullptr if the page cannot be written directly
+    virtual std::byte* get_host_write_pointer( Addr /* addr */) noexcept { return nullptr; }
+    mutable SoftwareTLB<std::byte*> write_tlb;
 private:
     void write_string_by_size( const std::string& value, Addr addr, size_t size);
 };
@@ -164,6 +191,19 @@ public:
         return create_plain_memory( 22);
     }
 
+    // Reserves the whole address space on host, pages are allocated on the first touch
+    static std::shared_ptr<FuncMemory> create_mmap_memory( uint32 addr_bits);
+    static std::shared_ptr<FuncMemory> create_default_mmap_memory()
+    {
+        return create_mmap_memory( 36);
+    }
+
+    static std::shared_ptr<FuncMemory> create_configured_memory();
+
+    // Returns a memory with the same contents, later writes to either of them are not visible in the other one.
+    // Hierarchied memory shares pages until they are written, others are copied.
+    virtual std::shared_ptr<FuncMemory> snapshot() const;
+
     template<typename T, std::endian endian> void masked_write( T value, Addr addr, T mask)
     {
         T combined_value = ( value & mask) | ( this->read<T, endian>( addr) & ~mask);
@@ -171,7 +211,26 @@ public:
     }
 
     template<typename Instr> void load_store( Instr* instr);
+
+    const uint64* get_page_generation( Addr addr) const override;
+protected:
+    // Must be called by implementations on each write to the guest memory
+    void count_write( Addr addr, size_t size) noexcept;
+
+    // Implementations which keep pages of 2 ** page_bits bytes contiguous in host memory enable typed accesses
+    // without virtual calls. TLB has to be flushed if host memory of a page is moved.
+    void enable_tlb( uint32 page_bits) noexcept;
+    void flush_tlb() const noexcept;
+    virtual std::byte* get_host_data( Addr /* addr */) noexcept { return nullptr; }
+
 private:
+    std::byte* get_host_write_pointer( Addr addr) noexcept final;
+
+    // Only pages which generations were requested are tracked, so the most of writes do not touch the map
+    mutable std::unordered_map<Addr, uint64> page_generations;
+    mutable Addr lowest_tracked_page = all_ones<Addr>();
+    mutable Addr highest_tracked_page = 0;
+
     template<typename Instr, std::endian endian> void store( const Instr& instr);
     template<typename Instr, std::endian endian> void masked_store( const Instr& instr);
 };
@@ -214,6 +273,12 @@ public:
         primary->duplicate_to( memory);
     }
 
+    // Same as adding a replica, but the copy of the primary memory is created lazily
+    std::shared_ptr<FuncMemory> add_snapshot_replica()
+    {
+        return replicas.emplace_back( primary->snapshot());
+    }
+
     size_t memcpy_guest_to_host( std::byte* dst, Addr src, size_t size) const noexcept final
     {
         return primary->memcpy_guest_to_host( dst, src, size);
@@ -232,6 +297,16 @@ public:
         primary->duplicate_to( target);
     }
 
+    const uint64* get_page_generation( Addr addr) const final
+    {
+        return primary->get_page_generation( addr);
+    }
+
+    std::shared_ptr<FuncMemory> snapshot() const final
+    {
+        return primary->snapshot();
+    }
+
     std::string dump() const final
     {
         return primary->dump();
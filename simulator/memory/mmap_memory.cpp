@@ -0,0 +1,203 @@
+/**
+ * mmap_memory.cpp - flat guest memory backed by lazily allocated host pages
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include <memory/memory.h>
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+ * Reserves the whole guest address space without committing it,
+ * so host kernel supplies zeroed pages on the first touch
+ * and guest address is translated with a single addition.
+ */
+class MmapMemory : public FuncMemory
+{
+    public:
+        explicit MmapMemory( uint32 addr_bits);
+        ~MmapMemory() override;
+        MmapMemory( const MmapMemory&) = delete;
+        MmapMemory( MmapMemory&&) = delete;
+        MmapMemory& operator=( const MmapMemory&) = delete;
+        MmapMemory& operator=( MmapMemory&&) = delete;
+
+        std::string dump() const final;
+        size_t memcpy_host_to_guest( Addr dst, const std::byte* src, size_t size) final;
+        size_t memcpy_guest_to_host( std::byte* dst, Addr src, size_t size) const noexcept final;
+        void duplicate_to( std::shared_ptr<WriteableMemory> target) const final;
+        size_t strlen( Addr addr) const final;
+
+    protected:
+        const std::byte* get_host_read_pointer( Addr addr) const noexcept final;
+        std::byte* get_host_data( Addr addr) noexcept final;
+
+    private:
+        static std::byte* reserve( size_t size);
+
+        // Calls the visitor for each host page which is backed by physical memory and is not filled with zeroes
+        template<typename Visitor> void for_each_resident_page( Visitor visitor) const;
+
+        const size_t arena_size;
+        const size_t host_page_size;
+        std::byte* const arena;
+};
+
+std::shared_ptr<FuncMemory>
+FuncMemory::create_mmap_memory( uint32 addr_bits)
+{
+    return std::make_shared<MmapMemory>( addr_bits);
+}
+
+std::byte* MmapMemory::reserve( size_t size)
+{
+    // NOLINTNEXTLINE(hicpp-signed-bitwise) POSIX flags
+    void* result = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, performance-no-int-to-ptr) POSIX macro
+    if ( result == MAP_FAILED)
+        throw FuncMemoryBadMapping( "Cannot reserve " + std::to_string( size) + " bytes of host address space");
+
+    return static_cast<std::byte*>( result);
+}
+
+static size_t check_mmap_memory_size( uint32 addr_bits)
+{
+    // Leave a half of host address space for the simulator itself
+    if ( addr_bits >= bitwidth<size_t> - 1)
+        throw FuncMemoryBadMapping( "Too large address space ( 2 ** " + std::to_string( addr_bits) + " bytes)");
+
+    return size_t{ 1} << addr_bits;
+}
+
+MmapMemory::MmapMemory( uint32 addr_bits)
+    : arena_size( check_mmap_memory_size( addr_bits))
+    , host_page_size( narrow_cast<size_t>( sysconf( _SC_PAGESIZE)))
+    , arena( reserve( arena_size))
+{
+    enable_tlb( addr_bits);
+}
+
+MmapMemory::~MmapMemory()
+{
+    munmap( arena, arena_size);
+}
+
+const std::byte* MmapMemory::get_host_read_pointer( Addr addr) const noexcept
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+    return addr < arena_size ? arena + addr : nullptr;
+}
+
+std::byte* MmapMemory::get_host_data( Addr addr) noexcept
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+    return addr < arena_size ? arena + addr : nullptr;
+}
+
+size_t MmapMemory::memcpy_host_to_guest( Addr dst, const std::byte* src, size_t size)
+{
+    if ( size > arena_size)
+        throw FuncMemoryOutOfRange( dst + size, arena_size);
+
+    if ( dst > arena_size - size)
+        throw FuncMemoryOutOfRange( dst + size, arena_size);
+
+    count_write( dst, size);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+    std::memcpy( arena + dst, src, size);
+    return size;
+}
+
+size_t MmapMemory::memcpy_guest_to_host( std::byte* dst, Addr src, size_t size) const noexcept
+{
+    if ( src >= arena_size)
+        return 0;
+
+    const size_t valid_size = std::min<size_t>( size, arena_size - src);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+    std::memcpy( dst, arena + src, valid_size);
+    return valid_size;
+}
+
+size_t MmapMemory::strlen( Addr addr) const
+{
+    if ( addr >= arena_size)
+        return 0;
+
+    // Untouched pages are zeroes, so the search stops in the first of them
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+    const auto* begin = arena + addr;
+    const auto* zero = static_cast<const std::byte*>( std::memchr( begin, 0, arena_size - addr));
+    return zero == nullptr ? arena_size - addr : std::distance( begin, zero);
+}
+
+template<typename Visitor>
+void MmapMemory::for_each_resident_page( Visitor visitor) const
+{
+    // Query residency by portions to keep the vector small for large address spaces
+    static const constexpr size_t PAGES_PER_QUERY = 1ULL << 16U;
+    std::vector<unsigned char> residency( PAGES_PER_QUERY);
+    const auto is_zero = []( const std::byte* page, size_t page_size) {
+        return std::all_of( page, page + page_size, []( std::byte b) { return b == std::byte{}; }); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    };
+
+    const size_t pages = std::max<size_t>( arena_size / host_page_size, 1);
+    const size_t page_size = std::min( arena_size, host_page_size);
+    for ( size_t first = 0; first < pages; first += PAGES_PER_QUERY) {
+        const size_t count = std::min( PAGES_PER_QUERY, pages - first);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+        auto* chunk = arena + first * host_page_size;
+        if ( mincore( chunk, count * page_size, residency.data()) != 0)
+            std::fill_n( residency.begin(), count, 1); // Fall back to a full scan
+
+        for ( size_t i = 0; i < count; ++i) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+            const auto* page = chunk + i * host_page_size;
+            if ( ( residency[i] & 1U) != 0 && !is_zero( page, page_size))
+                visitor( ( first + i) * host_page_size, page, page_size);
+        }
+    }
+}
+
+void MmapMemory::duplicate_to( std::shared_ptr<WriteableMemory> target) const
+{
+    for_each_resident_page( [&target]( Addr addr, const std::byte* page, size_t page_size) {
+        target->memcpy_host_to_guest( addr, page, page_size);
+    });
+}
+
+std::string MmapMemory::dump() const
+{
+    std::ostringstream oss;
+    oss << std::setfill( '0') << std::hex;
+
+    for_each_resident_page( [&oss]( Addr addr, const std::byte* page, size_t page_size) {
+        for ( size_t i = 0; i < page_size; ++i)
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+            if ( uint32( page[i]) != 0)
+                oss << "addr 0x" << addr + i << ": data 0x" << uint32( page[i]) << std::endl;
+    });
+
+    return std::move( oss).str();
+}
+
+#else
+
+std::shared_ptr<FuncMemory>
+FuncMemory::create_mmap_memory( uint32 addr_bits)
+{
+    // Lazy reservation of address space is available only on Linux hosts
+    return create_hierarchied_memory( addr_bits, 10, 12);
+}
+
+#endif
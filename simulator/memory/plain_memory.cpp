@@ -22,6 +22,9 @@ class PlainMemory : public FuncMemory
         size_t memcpy_guest_to_host( std::byte* dst, Addr src, size_t size) const noexcept final;
         void duplicate_to( std::shared_ptr<WriteableMemory> target) const final;
         size_t strlen( Addr addr) const final;
+    protected:
+        const std::byte* get_host_read_pointer( Addr addr) const noexcept final;
+        std::byte* get_host_data( Addr addr) noexcept final;
     private:
         std::vector<std::byte> arena;
 };
@@ -32,7 +35,22 @@ FuncMemory::create_plain_memory( uint32 addr_bits)
     return std::make_shared<PlainMemory>( addr_bits);
 }
 
-PlainMemory::PlainMemory( uint32 addr_bits) : arena( 1ULL << addr_bits) { }
+PlainMemory::PlainMemory( uint32 addr_bits) : arena( 1ULL << addr_bits)
+{
+    enable_tlb( addr_bits);
+}
+
+const std::byte* PlainMemory::get_host_read_pointer( Addr addr) const noexcept
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+    return addr < arena.size() ? arena.data() + addr : nullptr;
+}
+
+std::byte* PlainMemory::get_host_data( Addr addr) noexcept
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+    return addr < arena.size() ? arena.data() + addr : nullptr;
+}
 
 void PlainMemory::duplicate_to( std::shared_ptr<WriteableMemory> target) const
 {
@@ -50,6 +68,7 @@ size_t PlainMemory::memcpy_host_to_guest( Addr dst, const std::byte* src, size_t
     if ( dst > arena.size() - size)
         throw FuncMemoryOutOfRange( dst + size, arena.size());
 
+    count_write( dst, size);
     // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) low-level access
     std::copy( src, src + size, arena.begin() + dst);
     return size;
@@ -0,0 +1,62 @@
+/**
+ * software_tlb.h - cache of guest to host page translations
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef SOFTWARE_TLB_H
+#define SOFTWARE_TLB_H
+
+#include <infra/macro.h>
+#include <infra/types.h>
+
+#include <array>
+#include <utility>
+
+/*
+ * Keeps host pointers to recently accessed guest pages,
+ * so aligned accesses skip virtual calls and page table walks of memory backends.
+ * Translation is disabled until the page size is set.
+ */
+template<typename Pointer>
+class SoftwareTLB
+{
+public:
+    SoftwareTLB() noexcept { flush(); }
+
+    void enable( uint32 bits) noexcept
+    {
+        page_bits = bits;
+        flush();
+    }
+
+    void flush() noexcept { entries.fill( { all_ones<Addr>(), nullptr}); }
+
+    // Returns host pointer for [addr, addr + size), or nullptr if the range cannot be accessed directly.
+    // 'fill' returns host pointer for guest address of the page beginning.
+    template<typename Fill>
+    Pointer translate( Addr addr, size_t size, Fill fill) noexcept
+    {
+        if ( page_bits == 0)
+            return nullptr;
+
+        const Addr page = addr >> page_bits;
+        if ( ( ( addr + size - 1) >> page_bits) != page)
+            return nullptr;
+
+        auto& entry = entries[ page % entries.size()];
+        if ( entry.first != page) {
+            Pointer host = fill( page << page_bits);
+            if ( host == nullptr)
+                return nullptr;
+            entry = { page, host};
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) Low level access
+        return entry.second + ( addr & bitmask<Addr>( page_bits));
+    }
+
+private:
+    uint32 page_bits = 0;
+    std::array<std::pair<Addr, Pointer>, 64> entries = {};
+};
+
+#endif // SOFTWARE_TLB_H
@@ -210,6 +210,48 @@ TEST_CASE( "Func_memory: Host_Guest_Memcpy_1024b")
         CHECK( read_data_1024.at(i) == write_data_1024.at(i));
 }
 
+TEST_CASE( "Hierarchied memory: Cross page memcpy")
+{
+    // 16-byte pages, 16 pages per set
+    auto func_mem = FuncMemory::create_hierarchied_memory( 16, 4, 4);
+
+    const constexpr size_t size = 100;
+    std::array<std::byte, size> write_data{};
+    for (size_t i = 0; i < size; i++)
+        write_data.at(i) = std::byte( i + 1);
+
+    CHECK( func_mem->memcpy_host_to_guest( 0xfb, write_data.data(), size) == size);
+
+    std::array<std::byte, size + 32> read_data{};
+    read_data.fill( std::byte( 0xFF));
+    CHECK( func_mem->memcpy_guest_to_host( read_data.data(), 0xfb - 16, read_data.size()) == read_data.size());
+    for (size_t i = 0; i < read_data.size(); i++)
+        CHECK( read_data.at(i) == ( i >= 16 && i < 16 + size ? write_data.at( i - 16) : std::byte{}));
+
+    CHECK( func_mem->strlen( 0xfb) == size);
+    CHECK( func_mem->strlen( 0xfb + 50) == size - 50);
+    CHECK( func_mem->strlen( 0x1000) == 0);
+
+    func_mem->memset( 0x105, std::byte{ 0}, 1);
+    CHECK( func_mem->strlen( 0xfb) == 0x105 - 0xfb);
+
+    func_mem->memset( 0x1ff0, std::byte{ 'a'}, 0x20);
+    CHECK( func_mem->strlen( 0x1ff0) == 0x20);
+}
+
+TEST_CASE( "Hierarchied memory: Duplicate sparse pages")
+{
+    auto mem1 = FuncMemory::create_hierarchied_memory( 16, 4, 4);
+    auto mem2 = FuncMemory::create_hierarchied_memory( 16, 4, 4);
+    mem1->write<uint32, std::endian::little>( 0x12345678, 0x10);
+    mem1->write<uint32, std::endian::little>( 0x9abcdef0, 0xfffc);
+
+    mem1->duplicate_to( mem2);
+    CHECK( mem1->dump() == mem2->dump());
+    CHECK( mem2->read<uint32, std::endian::little>( 0xfffc) == 0x9abcdef0);
+    CHECK( mem2->read<uint32, std::endian::little>( 0x800) == 0);
+}
+
 TEST_CASE( "Func_memory: Dump")
 {
     auto func_mem = FuncMemory::create_default_hierarchied_memory();
@@ -407,3 +449,172 @@ TEST_CASE( "Func_memory Replicant: read and write")
     CHECK( mem3->read_string( 0x20) == "Hello World");
     CHECK( mem12.dump() == mem1->dump());
 }
+
+TEST_CASE( "Func_memory: Page generations")
+{
+    for ( const auto& mem : { FuncMemory::create_4M_plain_memory(), FuncMemory::create_default_hierarchied_memory()}) {
+        const auto* generation = mem->get_page_generation( 0x1004);
+        REQUIRE( generation != nullptr);
+        CHECK( mem->get_page_generation( 0x1ffc) == generation);
+
+        const auto* next_generation = mem->get_page_generation( 0x2000);
+        CHECK( *next_generation != *generation);
+
+        const auto old_value = *generation;
+        mem->write<uint32, std::endian::little>( 0x1234, 0x3000);
+        CHECK( *generation == old_value);
+
+        mem->write<uint32, std::endian::little>( 0x1234, 0x1800);
+        CHECK( *generation > old_value);
+        CHECK( *generation > *next_generation);
+
+        // Write across the page boundary
+        const auto old_next_value = *next_generation;
+        mem->write<uint32, std::endian::little>( 0x1234, 0x1ffe);
+        CHECK( *next_generation > old_next_value);
+    }
+    CHECK( ReadableMemory::create_zero_memory()->get_page_generation( 0x1000) == nullptr);
+}
+
+TEST_CASE( "Func_memory Replicant: page generations")
+{
+    auto mem1 = FuncMemory::create_4M_plain_memory();
+    FuncMemoryReplicant mem12( mem1);
+    mem12.add_replica( FuncMemory::create_4M_plain_memory());
+
+    const auto* generation = mem12.get_page_generation( 0x20);
+    CHECK( generation == mem1->get_page_generation( 0x20));
+    const auto old_value = *generation;
+    mem12.write_string( "Hello World", 0x20);
+    CHECK( *generation > old_value);
+}
+
+TEST_CASE( "Func_memory: Typed accesses through TLB")
+{
+    for ( const auto& mem : { FuncMemory::create_4M_plain_memory(), FuncMemory::create_hierarchied_memory( 24, 4, 8)}) {
+        CHECK( mem->read<uint32, std::endian::little>( 0x1000) == 0);
+        mem->write<uint32, std::endian::little>( 0x12345678, 0x1000);
+        CHECK( mem->read<uint32, std::endian::little>( 0x1000) == 0x12345678);
+        CHECK( mem->read<uint32, std::endian::big>( 0x1000) == 0x78563412);
+        CHECK( mem->read<uint16, std::endian::little>( 0x1002) == 0x1234);
+
+        // Crosses a page boundary
+        mem->write<uint64, std::endian::big>( 0x0102030405060708, 0x10fc);
+        CHECK( mem->read<uint64, std::endian::big>( 0x10fc) == 0x0102030405060708);
+        CHECK( mem->read<uint32, std::endian::big>( 0x1100) == 0x05060708);
+
+        // Byte accesses see typed writes
+        mem->write<uint8, std::endian::little>( 0xab, 0x1001);
+        CHECK( mem->read<uint32, std::endian::little>( 0x1000) == 0x1234ab78);
+    }
+}
+
+TEST_CASE( "Func_memory: TLB does not hide writes to tracked pages")
+{
+    for ( const auto& mem : { FuncMemory::create_4M_plain_memory(), FuncMemory::create_default_hierarchied_memory()}) {
+        mem->write<uint32, std::endian::little>( 0x1, 0x2000);
+        const auto* generation = mem->get_page_generation( 0x2000);
+        const auto old_value = *generation;
+
+        mem->write<uint32, std::endian::little>( 0x2, 0x2004);
+        CHECK( *generation > old_value);
+        CHECK( mem->read<uint32, std::endian::little>( 0x2004) == 0x2);
+    }
+}
+
+TEST_CASE( "Hierarchied memory: out of range typed write")
+{
+    auto mem = FuncMemory::create_hierarchied_memory( 16, 4, 4);
+    mem->write<uint32, std::endian::little>( 0x1, 0xfff0);
+    CHECK_THROWS_AS( ( mem->write<uint32, std::endian::little>( 0x1, 0x1fff0)), FuncMemoryOutOfRange);
+}
+
+TEST_CASE( "Mmap memory: read and write")
+{
+    auto mem = FuncMemory::create_default_mmap_memory();
+    CHECK( mem->read<uint32, std::endian::little>( 0x8'0000'0000) == 0);
+
+    mem->write<uint32, std::endian::little>( 0x12345678, 0xf'ffff'fffc);
+    CHECK( mem->read<uint32, std::endian::little>( 0xf'ffff'fffc) == 0x12345678);
+
+    const std::string hw("Hello World!");
+    mem->memcpy_host_to_guest( 0x10ff8, byte_cast( hw.c_str()), hw.size());
+    CHECK( mem->read_string( 0x10ff8) == hw);
+    CHECK( mem->strlen( 0x10ff8) == hw.size());
+
+    CHECK_THROWS_AS( ( mem->write<uint32, std::endian::little>( 0x1, 0xf'ffff'fffe)), FuncMemoryOutOfRange);
+    CHECK_THROWS_AS( FuncMemory::create_mmap_memory( 64), FuncMemoryBadMapping);
+}
+
+TEST_CASE( "Mmap memory: Duplicate")
+{
+    auto mem1 = FuncMemory::create_default_mmap_memory();
+    auto mem2 = FuncMemory::create_default_hierarchied_memory();
+
+    ElfLoader( valid_elf_file).load_to( mem1.get());
+    mem1->read<uint32, std::endian::little>( 0x1000'0000); // touched, but zero page
+    mem1->duplicate_to( mem2);
+
+    CHECK( mem1->dump() == mem2->dump());
+    check_coherency( mem1.get(), mem2.get(), dataSectAddr);
+}
+
+TEST_CASE( "Mmap memory: Page generations")
+{
+    auto mem = FuncMemory::create_default_mmap_memory();
+    const auto* generation = mem->get_page_generation( 0x400000);
+    const auto old_value = *generation;
+    mem->write<uint32, std::endian::little>( 0x1, 0x400010);
+    CHECK( *generation > old_value);
+}
+
+TEST_CASE( "Func_memory: Snapshot")
+{
+    for ( const auto& mem : { FuncMemory::create_default_hierarchied_memory(), FuncMemory::create_4M_plain_memory()}) {
+        ElfLoader( valid_elf_file).load_to( mem.get(), -0x400000);
+        mem->write<uint32, std::endian::little>( 0x11111111, 0x2000); // fills TLB
+
+        auto snapshot = mem->snapshot();
+        CHECK( snapshot->dump() == mem->dump());
+        check_coherency( mem.get(), snapshot.get(), dataSectAddr - 0x400000);
+
+        mem->write<uint32, std::endian::little>( 0x22222222, 0x2000);
+        CHECK( mem->read<uint32, std::endian::little>( 0x2000) == 0x22222222);
+        CHECK( snapshot->read<uint32, std::endian::little>( 0x2000) == 0x11111111);
+
+        snapshot->write<uint32, std::endian::little>( 0x33333333, 0x2004);
+        snapshot->write<uint32, std::endian::little>( 0x44444444, 0x3000);
+        CHECK( mem->read<uint32, std::endian::little>( 0x2004) == 0);
+        CHECK( mem->read<uint32, std::endian::little>( 0x3000) == 0);
+        CHECK( snapshot->read<uint32, std::endian::little>( 0x2004) == 0x33333333);
+        CHECK( snapshot->read<uint32, std::endian::little>( 0x2000) == 0x11111111);
+    }
+}
+
+TEST_CASE( "Func_memory: Snapshot of snapshot")
+{
+    auto mem = FuncMemory::create_hierarchied_memory( 16, 4, 4);
+    mem->write<uint8, std::endian::little>( 1, 0x10);
+    auto snapshot1 = mem->snapshot();
+    auto snapshot2 = snapshot1->snapshot();
+
+    snapshot1->write<uint8, std::endian::little>( 2, 0x10);
+    mem->write<uint8, std::endian::little>( 3, 0x10);
+    CHECK( mem->read<uint8, std::endian::little>( 0x10) == 3);
+    CHECK( snapshot1->read<uint8, std::endian::little>( 0x10) == 2);
+    CHECK( snapshot2->read<uint8, std::endian::little>( 0x10) == 1);
+}
+
+TEST_CASE( "Func_memory Replicant: snapshot replica")
+{
+    auto mem1 = FuncMemory::create_default_hierarchied_memory();
+    mem1->write_string( "Hello", 0x20);
+    FuncMemoryReplicant mem12( mem1);
+    auto replica = mem12.add_snapshot_replica();
+    CHECK( replica->read_string( 0x20) == "Hello");
+
+    mem12.write_string( "World", 0x40);
+    mem1->write_string( "Bye", 0x20);
+    CHECK( replica->read_string( 0x40) == "World");
+    CHECK( replica->read_string( 0x20) == "Hello");
+}
@@ -12,13 +12,39 @@
 #include <infra/macro.h>
 #include <infra/types.h>
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <initializer_list>
 #include <iomanip>
 #include <iostream>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 template<Executable I> void do_nothing(I* /* instr */) { }
 
+// Fixed-capacity list of operands stored inline
+template<typename T, size_t N>
+class OperandList
+{
+public:
+    constexpr OperandList() = default;
+    constexpr OperandList( std::initializer_list<T> list) : count( list.size())
+    {
+        assert( list.size() <= N);
+        std::copy( list.begin(), list.end(), items.begin());
+    }
+
+    constexpr size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+    constexpr const T& operator[]( size_t index) const noexcept { return items[index]; }
+    constexpr const T& at( size_t index) const { return items.at( index); }
+
+private:
+    std::array<T, N> items = {};
+    size_t count = 0;
+};
+
 template<Executable I>
 struct MIPSTableEntry
 {
@@ -30,15 +56,35 @@ struct MIPSTableEntry
     uint8 mem_size = 0;
     char imm_type = 'N';
     Imm imm_print_type = Imm::NO;
-    std::vector<Src> src = { };
-    std::vector<Dst> dst = { Dst::ZERO };
+    OperandList<Src, MAX_SRC_NUM> src = { };
+    OperandList<Dst, MAX_DST_NUM> dst = { Dst::ZERO };
     MIPSVersionMask versions = MIPS_I_Instr;
 };
 
+// Dense table indexed by an instruction field, missing keys are unknown instructions
 template<Executable I>
-using Table = std::unordered_map<uint32, MIPSTableEntry<I>>;
+class Table
+{
+public:
+    // opcode and funct are 6 bits wide, other key fields are 5 bits wide
+    static constexpr size_t CAPACITY = 64;
+
+    Table( std::initializer_list<std::pair<uint32, MIPSTableEntry<I>>> list)
+    {
+        for ( const auto& [key, entry] : list)
+            entries.at( key) = entry;
+    }
+
+    const MIPSTableEntry<I>& operator[]( uint32 key) const noexcept { return entries[key]; }
 
-//unordered map for R-instructions
+    auto begin() const noexcept { return entries.begin(); }
+    auto end() const noexcept { return entries.end(); }
+
+private:
+    std::array<MIPSTableEntry<I>, CAPACITY> entries = {};
+};
+
+//table for R-instructions
 template<Executable I>
 static const Table<I> isaMapR =
 {
@@ -117,7 +163,7 @@ static const Table<I> isaMapR =
     {0x3F, { "dsra32", Shifter::dsra32<I>, OUT_ARITHM, 0, 'S', Imm::SHIFT, { Src::RT }, { Dst::RD }, MIPS_III_Instr} }
 };
 
-//unordered map for RI-instructions
+//table for RI-instructions
 template<Executable I>
 static const Table<I> isaMapRI =
 {
@@ -140,7 +186,7 @@ static const Table<I> isaMapRI =
     {0x13, { "bgezall", ALU::branch_and_link<I, &I::gez>, OUT_BRANCH_LIKELY, 0, 'I', Imm::ARITH, { Src::RS }, { Dst::RA }, MIPS_II_Instr} }
 };
 
-//unordered map for I-instructions and J-instructions
+//table for I-instructions and J-instructions
 template<Executable I>
 static const Table<I> isaMapIJ =
 {
@@ -457,99 +503,84 @@ static const MIPSTableEntry<I> instr_nop =
 { "nop" , do_nothing<I>, OUT_ARITHM, 0, 'N', Imm::NO, { }, { Dst::ZERO }, MIPS_I_Instr};
 
 template<Executable I>
-static MIPSTableEntry<I> get_table_entry( const Table<I>& table, uint32 key)
-{
-    auto it = table.find( key);
-    return it == table.end() ? unknown_instruction<I> : it->second;
-}
-
-template<Executable I>
-static MIPSTableEntry<I> get_opcode_special_entry( const MIPSInstrDecoder& instr)
+static const MIPSTableEntry<I>& get_opcode_special_entry( const MIPSInstrDecoder& instr)
 {
     if ( instr.funct == 0x1)
-        return get_table_entry( isaMapMOVCI<I>, instr.ft);
-    return get_table_entry( isaMapR<I>, instr.funct);
+        return isaMapMOVCI<I>[instr.ft];
+    return isaMapR<I>[instr.funct];
 }
 
 template<Executable I>
-static MIPSTableEntry<I> get_COP1_s_entry( const MIPSInstrDecoder& instr)
+static const MIPSTableEntry<I>& get_COP1_s_entry( const MIPSInstrDecoder& instr)
 {
     if ( instr.funct == 0x11)
-        return get_table_entry( isaMapMOVCF_s<I>, instr.ft);
-    return get_table_entry( isaMapCOP1_s<I>, instr.funct);
+        return isaMapMOVCF_s<I>[instr.ft];
+    return isaMapCOP1_s<I>[instr.funct];
 }
 
 template<Executable I>
-static MIPSTableEntry<I> get_COP1_d_entry( const MIPSInstrDecoder& instr)
+static const MIPSTableEntry<I>& get_COP1_d_entry( const MIPSInstrDecoder& instr)
 {
     if ( instr.funct == 0x11)
-        return get_table_entry( isaMapMOVCF_d<I>, instr.ft);
-    return get_table_entry( isaMapCOP1_d<I>,  instr.funct);
+        return isaMapMOVCF_d<I>[instr.ft];
+    return isaMapCOP1_d<I>[instr.funct];
 }
 
 template<Executable I>
-static MIPSTableEntry<I> get_cp0_entry( const MIPSInstrDecoder& instr)
+static const MIPSTableEntry<I>& get_cp0_entry( const MIPSInstrDecoder& instr)
 {
     switch ( instr.funct)
     {
-        case 0x0:  return get_table_entry( isaMapCOP0_rs<I>,    instr.rs);
-        default:   return get_table_entry( isaMapCOP0_funct<I>, instr.funct);
+        case 0x0:  return isaMapCOP0_rs<I>[instr.rs];
+        default:   return isaMapCOP0_funct<I>[instr.funct];
     }
 }
 
 template<Executable I>
-static MIPSTableEntry<I> get_cp1_entry( const MIPSInstrDecoder& instr)
+static const MIPSTableEntry<I>& get_cp1_entry( const MIPSInstrDecoder& instr)
 {
     switch ( instr.fmt)
     {
-        case 0x8:  return get_table_entry( isaMapCOP1I<I>,  instr.ft);
+        case 0x8:  return isaMapCOP1I<I>[instr.ft];
         case 0x10: return get_COP1_s_entry<I>( instr);
         case 0x11: return get_COP1_d_entry<I>( instr);
-        case 0x14: return get_table_entry( isaMapCOP1_w<I>, instr.funct);
-        case 0x15: return get_table_entry( isaMapCOP1_l<I>, instr.funct);
-        default:   return get_table_entry( isaMapCOP1<I>,   instr.fmt);
+        case 0x14: return isaMapCOP1_w<I>[instr.funct];
+        case 0x15: return isaMapCOP1_l<I>[instr.funct];
+        default:   return isaMapCOP1<I>[instr.fmt];
     }
 }
 
 template<Executable I>
-static MIPSTableEntry<I> get_table_entry( uint32 bytes)
+static const MIPSTableEntry<I>& get_table_entry( const MIPSInstrDecoder& instr)
 {
-    MIPSInstrDecoder instr( bytes);
-
     if ( instr.bytes == 0)
         return instr_nop<I>;
 
     switch ( instr.opcode)
     {
         case 0x0:  return get_opcode_special_entry<I>( instr);
-        case 0x1:  return get_table_entry( isaMapRI<I>,     instr.rt);
+        case 0x1:  return isaMapRI<I>[instr.rt];
         case 0x10: return get_cp0_entry<I>( instr);
         case 0x11: return get_cp1_entry<I>( instr);
-        case 0x13: return get_table_entry( isaMapCOP1X<I>,  instr.funct);
-        case 0x1C: return get_table_entry( isaMapMIPS32<I>, instr.funct);
-        default:   return get_table_entry( isaMapIJ<I>,     instr.opcode);
+        case 0x13: return isaMapCOP1X<I>[instr.funct];
+        case 0x1C: return isaMapMIPS32<I>[instr.funct];
+        default:   return isaMapIJ<I>[instr.opcode];
     }
 }
 
-template<typename M>
-static auto find_entry( const M& map, std::string_view name)
-{
-    return std::find_if( map.begin(), map.end(), [name]( const auto& e) {
-        return e.second.name == name;
-    });
-}
-
 template<Executable I>
-static MIPSTableEntry<I> get_table_entry( std::string_view str_opcode)
+static const MIPSTableEntry<I>& get_table_entry( std::string_view str_opcode)
 {
     if ( str_opcode == "nop")
         return instr_nop<I>;
 
     for ( const auto& map : all_isa_maps<I>)
     {
-        auto res = find_entry( *map, str_opcode);
+        auto res = std::find_if( map->begin(), map->end(), [str_opcode]( const auto& e) {
+            return e.name == str_opcode;
+        });
         if ( res != map->end())
-            return res->second;
+            return *res;
     }
 
     return unknown_instruction<I>;
@@ -562,8 +593,8 @@ BaseMIPSInstr<R>::BaseMIPSInstr( MIPSVersion version, std::endian endian, uint32
     , raw_valid( true)
     , endian( endian)
 {
-    auto entry = get_table_entry<MyDatapath>( raw);
     MIPSInstrDecoder instr( raw);
+    const auto& entry = get_table_entry<MyDatapath>( instr);
     init( entry, version);
 
     for ( size_t i = 0; i < entry.src.size(); ++i)
@@ -581,7 +612,7 @@ BaseMIPSInstr<R>::BaseMIPSInstr( MIPSVersion version, std::string_view str_opcod
     , raw( 0)
     , endian( endian)
 {
-    auto entry = get_table_entry<MyDatapath>( str_opcode);
+    const auto& entry = get_table_entry<MyDatapath>( str_opcode);
     init( entry, version);
     this->v_imm = MIPSInstrDecoder::get_immediate<R>( entry.imm_type, immediate);
     init_target();
@@ -621,7 +652,8 @@ void BaseMIPSInstr<R>::init( const MIPSTableEntry<MyDatapath>& entry, MIPSVersio
 template<Unsigned R>
 typename BaseMIPSInstr<R>::DisasmCache& BaseMIPSInstr<R>::get_disasm_cache()
 {
-    static DisasmCache instance;
+    // Each thread has its own cache, so instructions may be disassembled by simulators on different threads
+    thread_local DisasmCache instance;
     return instance;
 }
 
@@ -35,6 +35,7 @@ class BaseMIPSInstr : public BaseInstruction<R, MIPSRegister>
 
         auto get_endian() const { return endian; }
 
+        uint32 get_bytes() const { return raw; }
         bool is_same_bytes( uint32 bytes) const {
             return raw == bytes;
         }
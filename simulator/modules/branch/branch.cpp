@@ -8,7 +8,9 @@
 
 template <typename FuncInstr>
 Branch<FuncInstr>::Branch( Module* parent) : Module( parent, "branch")
-{ }
+{
+    add_wakeup_port( rp_datapath);
+}
 
 template <typename FuncInstr>
 void Branch<FuncInstr>::clock( Cycle cycle)
@@ -0,0 +1,211 @@
+/*
+ * hybrid_sim.cpp - functional fast-forward followed by performance simulation
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include "hybrid_sim.h"
+
+#include <kernel/kernel.h>
+
+#include <algorithm>
+
+template <ISA I>
+HybridSim<I>::HybridSim( std::endian endian, std::string_view isa, uint64 fast_forward, const SamplingParameters& sampling)
+    : Simulator( isa)
+    , funcsim( std::make_unique<FuncSim<I>>( endian, false, isa))
+    , perfsim( std::make_unique<PerfSim<I>>( endian, isa))
+    , warmer( perfsim.get())
+    , fast_forward( fast_forward)
+    , sampling( sampling)
+{
+    funcsim->set_observer( &warmer);
+    if ( sampling.is_enabled())
+        perfsim->set_statistics_dump( false);
+
+    active = get_initial_simulator();
+    report.confidence_z = sampling.confidence_z;
+}
+
+template <ISA I>
+Simulator* HybridSim<I>::get_initial_simulator() const
+{
+    if ( sampling.is_enabled() || fast_forward != 0)
+        return funcsim.get();
+
+    return perfsim.get();
+}
+
+template <ISA I>
+void HybridSim<I>::reset()
+{
+    funcsim->reset();
+    perfsim->reset();
+    active = get_initial_simulator();
+    kernel = nullptr;
+    has_perfsim_kernel = false;
+    report = SamplingReport();
+    report.confidence_z = sampling.confidence_z;
+}
+
+template <ISA I>
+void HybridSim<I>::set_memory( std::shared_ptr<FuncMemory> memory)
+{
+    funcsim->set_memory( memory);
+    perfsim->set_memory( std::move( memory));
+}
+
+template <ISA I>
+void HybridSim<I>::set_kernel( std::shared_ptr<Kernel> k)
+{
+    kernel = std::move( k);
+    funcsim->set_kernel( kernel);
+    // Checker of performance simulator copies the state at the moment of the switch
+    if ( !is_fast_forwarding()) {
+        perfsim->set_kernel( kernel);
+        has_perfsim_kernel = true;
+    }
+}
+
+template <ISA I>
+void HybridSim<I>::enable_driver_hooks()
+{
+    funcsim->enable_driver_hooks();
+    perfsim->enable_driver_hooks();
+}
+
+template <ISA I>
+void HybridSim<I>::switch_to_funcsim()
+{
+    if ( is_fast_forwarding())
+        return;
+
+    perfsim->duplicate_all_registers_to( funcsim.get());
+    funcsim->set_target( perfsim->get_target());
+    active = funcsim.get();
+}
+
+template <ISA I>
+Trap HybridSim<I>::switch_to_perfsim( uint64* executed)
+{
+    if ( !is_fast_forwarding())
+        return Trap( Trap::BREAKPOINT);
+
+    // Delay slots cannot be handed over, so complete the branch functionally
+    auto trap = Trap( Trap::BREAKPOINT);
+    while ( trap == Trap::BREAKPOINT && !funcsim->get_target().valid) {
+        const auto before = *executed;
+        trap = run_functional( 1, executed);
+        if ( *executed == before)
+            throw Exception( "Functional simulator does not leave the delay slot");
+    }
+    if ( trap != Trap::BREAKPOINT)
+        return trap;
+
+    funcsim->duplicate_all_registers_to( perfsim.get());
+    active = perfsim.get();
+    if ( !has_perfsim_kernel && kernel != nullptr) {
+        perfsim->set_kernel( kernel);
+        has_perfsim_kernel = true;
+        // Checker would fall behind while functional simulator runs between sampled windows
+        if ( sampling.is_enabled())
+            perfsim->disable_checker();
+    }
+    perfsim->restart_pipeline( funcsim->get_target());
+    return trap;
+}
+
+template <ISA I>
+Trap HybridSim<I>::run_functional( uint64 instrs_to_run, uint64* executed)
+{
+    if ( instrs_to_run == 0)
+        return Trap( Trap::BREAKPOINT);
+
+    switch_to_funcsim();
+    const auto start = funcsim->get_executed_instrs();
+    const auto trap = funcsim->run( instrs_to_run);
+    *executed += funcsim->get_executed_instrs() - start;
+    return trap;
+}
+
+template <ISA I>
+Trap HybridSim<I>::run_detailed( uint64 instrs_to_run, uint64* executed)
+{
+    if ( instrs_to_run == 0)
+        return Trap( Trap::BREAKPOINT);
+
+    const auto before = *executed;
+    auto trap = switch_to_perfsim( executed);
+    if ( trap != Trap::BREAKPOINT || *executed - before >= instrs_to_run)
+        return trap;
+
+    const auto start = perfsim->get_statistics().instrs;
+    trap = perfsim->run( instrs_to_run - ( *executed - before));
+    *executed += perfsim->get_statistics().instrs - start;
+    return trap;
+}
+
+template <ISA I>
+Trap HybridSim<I>::run( uint64 instrs_to_run)
+{
+    if ( sampling.is_enabled())
+        return run_sampled( instrs_to_run);
+
+    if ( !is_fast_forwarding())
+        return perfsim->run( instrs_to_run);
+
+    uint64 executed = 0;
+    const auto trap = run_functional( std::min( instrs_to_run, fast_forward - funcsim->get_executed_instrs()), &executed);
+    if ( funcsim->get_executed_instrs() < fast_forward || trap != Trap::BREAKPOINT)
+        return trap;
+
+    // Instructions of the delay slot are counted, so the switch waits for the next call if nothing is left
+    if ( executed >= instrs_to_run)
+        return trap;
+
+    return run_detailed( instrs_to_run - executed, &executed);
+}
+
+template <ISA I>
+Trap HybridSim<I>::run_sampled( uint64 instrs_to_run)
+{
+    uint64 executed = 0;
+    // Several instructions may be written back at the last cycle of a detailed run
+    auto left = [&]() { return executed >= instrs_to_run ? 0 : instrs_to_run - executed; };
+    const auto skip = sampling.period - std::min( sampling.period, sampling.warm_up + sampling.window);
+
+    auto trap = Trap( Trap::BREAKPOINT);
+    if ( funcsim->get_executed_instrs() < fast_forward)
+        trap = run_functional( std::min( left(), fast_forward - funcsim->get_executed_instrs()), &executed);
+
+    while ( trap == Trap::BREAKPOINT && left() != 0 && !report.is_accurate( sampling)) {
+        trap = run_functional( std::min( left(), skip), &executed);
+        if ( trap != Trap::BREAKPOINT)
+            break;
+
+        trap = run_detailed( std::min( left(), sampling.warm_up), &executed);
+        if ( trap != Trap::BREAKPOINT || left() < sampling.window)
+            break;
+
+        const auto before = perfsim->get_statistics();
+        trap = run_detailed( sampling.window, &executed);
+        if ( trap == Trap::BREAKPOINT)
+            report.add( perfsim->get_statistics() - before);
+    }
+
+    return trap;
+}
+
+#include <mips/mips.h>
+#include <risc_v/risc_v.h>
+
+template class HybridSim<MIPSI>;
+template class HybridSim<MIPSII>;
+template class HybridSim<MIPSIII>;
+template class HybridSim<MIPSIV>;
+template class HybridSim<MIPS32>;
+template class HybridSim<MIPS64>;
+template class HybridSim<MARS>;
+template class HybridSim<MARS64>;
+template class HybridSim<RISCV32>;
+template class HybridSim<RISCV64>;
+template class HybridSim<RISCV128>;
@@ -0,0 +1,89 @@
+/*
+ * hybrid_sim.h - functional fast-forward followed by performance simulation
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef HYBRID_SIM_H
+#define HYBRID_SIM_H
+
+#include "perf_sim.h"
+#include "sampling.h"
+
+#include <func_sim/func_sim.h>
+#include <simulator.h>
+
+#include <memory>
+
+/*
+ * Runs functional simulator for the first 'fast_forward' instructions,
+ * warming up branch predictor and instruction cache of performance simulator.
+ * Then architectural state is handed over to performance simulator,
+ * which runs the rest of instructions in details.
+ * If sampling is enabled, simulators are switched periodically
+ * to measure short windows in details only.
+ */
+template <ISA I>
+class HybridSim : public Simulator
+{
+public:
+    HybridSim( std::endian endian, std::string_view isa, uint64 fast_forward, const SamplingParameters& sampling = {});
+
+    Trap run( uint64 instrs_to_run) final;
+    void set_target( const Target& target) final { active->set_target( target); }
+    void set_memory( std::shared_ptr<FuncMemory> memory) final;
+    void set_kernel( std::shared_ptr<Kernel> k) final;
+    void disable_checker() final { perfsim->disable_checker(); }
+    void enable_driver_hooks() final;
+    int get_exit_code() const noexcept final { return active->get_exit_code(); }
+    Target get_target() const final { return active->get_target(); }
+    uint64 get_executed_instrs() const final { return funcsim->get_executed_instrs() + perfsim->get_executed_instrs(); }
+    void reset() final;
+
+    bool is_fast_forwarding() const { return active == funcsim.get(); }
+    const SamplingReport* get_sampling_report() const final { return sampling.is_enabled() ? &report : nullptr; }
+
+    Addr get_pc() const final { return active->get_pc(); }
+    size_t sizeof_register() const final { return active->sizeof_register(); }
+    size_t max_cpu_register() const final { return active->max_cpu_register(); }
+
+    uint64 read_cpu_register( size_t regno) const final { return active->read_cpu_register( regno); }
+    uint64 read_gdb_register( size_t regno) const final { return active->read_gdb_register( regno); }
+    uint64 read_csr_register( std::string_view name) const final { return active->read_csr_register( name); }
+
+    void write_cpu_register( size_t regno, uint64 value) final { active->write_cpu_register( regno, value); }
+    void write_gdb_register( size_t regno, uint64 value) final { active->write_gdb_register( regno, value); }
+    void write_csr_register( std::string_view name, uint64 value) final { active->write_csr_register( name, value); }
+
+private:
+    using FuncInstr = typename I::FuncInstr;
+
+    class Warmer final : public FuncSimObserver<FuncInstr>
+    {
+    public:
+        explicit Warmer( PerfSim<I>* perfsim) : perfsim( perfsim) { }
+        void observe( const FuncInstr& instr) final { perfsim->warm_up( instr); }
+    private:
+        PerfSim<I>* const perfsim;
+    };
+
+    void switch_to_funcsim();
+    // Returns a trap if it occurs in a delay slot, which is completed functionally before the switch
+    Trap switch_to_perfsim( uint64* executed);
+    Trap run_functional( uint64 instrs_to_run, uint64* executed);
+    Trap run_detailed( uint64 instrs_to_run, uint64* executed);
+    Trap run_sampled( uint64 instrs_to_run);
+
+    Simulator* get_initial_simulator() const;
+
+    std::unique_ptr<FuncSim<I>> funcsim;
+    std::unique_ptr<PerfSim<I>> perfsim;
+    Warmer warmer;
+    Simulator* active = nullptr;
+    std::shared_ptr<Kernel> kernel;
+    bool has_perfsim_kernel = false;
+    uint64 fast_forward;
+    const SamplingParameters sampling;
+    SamplingReport report;
+};
+
+#endif // HYBRID_SIM_H
@@ -13,6 +13,8 @@
 namespace config {
     static const AliasedValue<std::string> units_to_log = { "l", "logs", "nothing", "print logs for modules"};
     static const Switch topology_dump = { "tdump", "module topology dump into topology.json" };
+    static const Switch no_cycle_skipping = { "no-cycle-skipping", "clock all modules even in cycles when no port has data" };
+    static const Switch no_clock_gating = { "no-clock-gating", "clock each module even in cycles when its inputs are empty" };
 } // namespace config
 
 template <ISA I>
@@ -30,13 +32,16 @@ PerfSim<I>::PerfSim( std::endian endian, std::string_view isa)
     init_portmap();
     enable_logging( config::units_to_log);
     topology_dumping( config::topology_dump, "topology.json");
+    // Skipped cycles would be missing in logs
+    is_cycle_skipping_enabled = !config::no_cycle_skipping && !has_logging();
+    is_clock_gating_enabled = !config::no_clock_gating && !has_logging();
 }
 
 template <ISA I>
 void PerfSim<I>::set_memory( std::shared_ptr<FuncMemory> m)
 {
     memory = m;
-    auto imemory = std::make_unique<InstrMemoryCached<I>>( endian);
+    auto imemory = std::make_unique<InstrMemoryCached<I>>( endian, InstrCacheParameters::create_configured());
     imemory->set_memory( m);
     fetch.set_memory( std::move( imemory));
     mem.set_memory( m);
@@ -48,6 +53,28 @@ void PerfSim<I>::set_target( const Target& target)
     writeback.set_target( target, curr_cycle);
 }
 
+template <ISA I>
+void PerfSim<I>::restart_pipeline( const Target& target)
+{
+    // Flush is visible to all stages in the next cycle, so nothing can be written back before it
+    set_target( target);
+    curr_cycle.inc();
+}
+
+template <ISA I>
+void PerfSim<I>::reset()
+{
+    curr_cycle = 0_cl;
+    current_trap = Trap( Trap::NO_TRAP);
+    rf.reset();
+    reset_portmap();
+    fetch.reset();
+    decode.reset();
+    execute.reset();
+    branch.reset();
+    writeback.reset();
+}
+
 template<ISA I>
 Addr PerfSim<I>::get_pc() const
 {
@@ -59,14 +86,21 @@ Trap PerfSim<I>::run( uint64 instrs_to_run)
 {
     current_trap = Trap( Trap::NO_TRAP);
 
-    writeback.set_instrs_to_run( instrs_to_run);
+    const auto executed_instrs = writeback.get_executed_instrs();
+    writeback.set_instrs_to_run( instrs_to_run > MAX_VAL64 - executed_instrs ? MAX_VAL64 : executed_instrs + instrs_to_run);
 
     start_time = std::chrono::high_resolution_clock::now();
 
-    while (current_trap == Trap::NO_TRAP)
+    while (current_trap == Trap::NO_TRAP) {
         clock();
+        if ( is_cycle_skipping_enabled && current_trap == Trap::NO_TRAP)
+            skip_idle_cycles();
+    }
 
-    dump_statistics();
+    writeback.sync_checker();
+
+    if ( is_statistics_dump_enabled)
+        dump_statistics();
 
     return current_trap;
 }
@@ -78,20 +112,48 @@ void PerfSim<I>::clock()
     curr_cycle.inc();
 }
 
+template<ISA I>
+void PerfSim<I>::skip_idle_cycles()
+{
+    // Writeback has to throw Deadlock in the same cycle as if all cycles were clocked
+    const auto next_cycle = get_earliest_ready_cycle( curr_cycle, writeback.get_deadlock_cycle());
+    if ( next_cycle <= curr_cycle)
+        return;
+
+    const auto count = ( next_cycle - curr_cycle).to_size_t();
+    fetch.skip_idle_cycles();
+    decode.skip_idle_cycles( count);
+    execute.skip_idle_cycles( count);
+    curr_cycle = next_cycle;
+}
+
 template<ISA I>
 void PerfSim<I>::clock_tree( Cycle cycle)
 {
     fetch.clock( cycle);
     decode.clock( cycle);
-    execute.clock( cycle);
-    mem.clock( cycle);
-    branch.clock( cycle);
+    if ( is_awake( execute, cycle))
+        execute.clock( cycle);
+    else
+        execute.skip_idle_cycles( 1);
+    if ( is_awake( mem, cycle))
+        mem.clock( cycle);
+    if ( is_awake( branch, cycle))
+        branch.clock( cycle);
     writeback.clock( cycle);
     if ( rp_halt->is_ready( cycle))
         current_trap = rp_halt->read( cycle);
     sout << "******************\n";
 }
 
+template<ISA I>
+PerfStatistics PerfSim<I>::get_statistics() const
+{
+    return { writeback.get_executed_instrs(), uint64{ curr_cycle},
+             branch.get_jumps_num(), decode.get_mispredictions_num() + branch.get_mispredictions_num(),
+             fetch.get_icache_accesses(), fetch.get_icache_misses() };
+}
+
 auto get_rate( int total, float64 piece)
 {
     return total != 0 ? ( piece / total * 100) : 0;
@@ -7,6 +7,7 @@
 #define PERF_SIM_H
 
 #include "perf_instr.h"
+#include "sampling.h"
 
 #include <modules/branch/branch.h>
 #include <modules/decode/decode.h>
@@ -14,6 +15,7 @@
 #include <modules/fetch/fetch.h>
 #include <modules/mem/mem.h>
 #include <modules/ports_instance.h>
+#include <modules/ports_topology.h>
 #include <modules/writeback/writeback.h>
 #include <simulator.h>
 
@@ -28,19 +30,27 @@ public:
     explicit PerfSim( std::endian endian, std::string_view isa);
     Trap run( uint64 instrs_to_run) final;
     void set_target( const Target& target) final;
+    // Drops instructions left in the pipeline by a previous run
+    void restart_pipeline( const Target& target);
+    void reset() final;
     void set_memory( std::shared_ptr<FuncMemory> memory) final;
     void set_kernel( std::shared_ptr<Kernel> k) final { writeback.set_kernel( k, get_isa()); }
     void disable_checker() final { writeback.disable_checker(); }
     void clock() final;
     void enable_driver_hooks() final { writeback.enable_driver_hooks(); }
     void set_writeback_bandwidth( uint32 wb_bandwidth) { decode.set_wb_bandwidth( wb_bandwidth);}
+    void warm_up( const typename I::FuncInstr& instr) { fetch.warm_up( instr); }
+    PerfStatistics get_statistics() const final;
+    void set_statistics_dump( bool value) final { is_statistics_dump_enabled = value; }
     int get_exit_code() const noexcept final { return writeback.get_exit_code(); }
 
     size_t sizeof_register() const final { return bytewidth<RegisterUInt>; }
     size_t max_cpu_register() const final { return Register::MAX_REG; }
 
     Addr get_pc() const final;
-    
+    Target get_target() const final { return writeback.get_next_target(); }
+    uint64 get_executed_instrs() const final { return writeback.get_executed_instrs(); }
+
     uint64 read_cpu_register( size_t regno) const final { return read_register( Register::from_cpu_index( regno)); }
     uint64 read_gdb_register( size_t regno) const final;
     uint64 read_csr_register( std::string_view reg_name) const final { return read_register( Register::from_csr_name( reg_name)); }
@@ -58,6 +68,8 @@ public:
 private:
     using FuncInstr = typename I::FuncInstr;
     using Instr = PerfInstr<FuncInstr>;
+    using Ports = PipelinePorts<FuncInstr>;
+    static_assert( has_unique_port_names<FuncInstr>(), "Pipeline ports must have unique names");
 
     Cycle curr_cycle = 0_cl;
     decltype( std::chrono::high_resolution_clock::now()) start_time = {};
@@ -75,10 +87,18 @@ private:
     Writeback<I> writeback;
 
     /* ports */
-    ReadPort<Trap>* rp_halt = make_read_port<Trap>("WRITEBACK_2_CORE_HALT", Port::LATENCY);
+    ReadPort<Trap>* rp_halt = make_read_port( Ports::WRITEBACK_2_CORE_HALT, Port::LATENCY);
 
     void clock_tree( Cycle cycle);
+    // Moves to the next cycle when any port has data, modules are updated as if they were clocked
+    void skip_idle_cycles();
+    bool is_cycle_skipping_enabled = true;
+    // Execute, memory and branch stages are not clocked in cycles when they have nothing to do.
+    // Fetch, decode and writeback are clocked each cycle, so deadlock is detected as before.
+    bool is_clock_gating_enabled = true;
+    bool is_awake( const Module& module, Cycle cycle) const { return !is_clock_gating_enabled || module.is_awake( cycle); }
     void dump_statistics() const;
+    bool is_statistics_dump_enabled = true;
     Trap current_trap = Trap(Trap::NO_TRAP);
 
     uint64 read_register( Register index) const { return narrow_cast<uint64>( rf.read( index)); }
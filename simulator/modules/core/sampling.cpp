@@ -0,0 +1,93 @@
+/*
+ * sampling.cpp - statistical sampling of performance simulation
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include "sampling.h"
+
+#include <infra/config/config.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace config {
+    static const Value<uint64> sampling_period = { "sampling-period", 0, "number of instructions between sampled windows, 0 disables sampling"};
+    static const Value<uint64> sampling_warm_up = { "sampling-warm-up", 2000, "number of detailed instructions before each sampled window"};
+    static const Value<uint64> sampling_window = { "sampling-window", 1000, "number of instructions in a sampled window"};
+    static const Value<uint32> sampling_error = { "sampling-error", 3, "target relative error of IPC in percent"};
+} // namespace config
+
+SamplingParameters SamplingParameters::create_configured()
+{
+    SamplingParameters result;
+    result.period = config::sampling_period;
+    result.warm_up = config::sampling_warm_up;
+    result.window = config::sampling_window;
+    result.target_error = config::sampling_error / 100.0;
+    return result;
+}
+
+void SampleEstimator::add( double value)
+{
+    ++count;
+    const double delta = value - mean;
+    mean += delta / double( count);
+    m2 += delta * ( value - mean);
+}
+
+double SampleEstimator::get_variance() const
+{
+    return count < 2 ? 0 : m2 / double( count - 1);
+}
+
+double SampleEstimator::get_half_width( double z) const
+{
+    if ( count < 2)
+        return std::numeric_limits<double>::infinity();
+
+    return z * std::sqrt( get_variance() / double( count));
+}
+
+double SampleEstimator::get_relative_error( double z) const
+{
+    const auto half_width = get_half_width( z);
+    if ( mean == 0)
+        return half_width == 0 ? 0 : std::numeric_limits<double>::infinity();
+
+    return half_width / std::abs( mean);
+}
+
+void SamplingReport::add( const PerfStatistics& window)
+{
+    if ( window.cycles != 0)
+        ipc.add( double( window.instrs) / double( window.cycles));
+    if ( window.jumps != 0)
+        mispredict_rate.add( double( window.mispredictions) / double( window.jumps));
+    if ( window.icache_accesses != 0)
+        icache_miss_rate.add( double( window.icache_misses) / double( window.icache_accesses));
+}
+
+bool SamplingReport::is_accurate( const SamplingParameters& params) const
+{
+    return ipc.get_count() >= params.min_samples
+        && ipc.get_relative_error( params.confidence_z) <= params.target_error;
+}
+
+static void dump_estimation( std::ostream& out, const SampleEstimator& value, double z)
+{
+    out << value.get_mean() << " +- " << value.get_half_width( z) << " (" << value.get_count() << " samples)";
+}
+
+std::ostream& operator<<( std::ostream& out, const SamplingReport& rhs)
+{
+    const auto z = rhs.confidence_z;
+    out << std::endl << "****************************"
+        << std::endl << "sampled IPC:         ";
+    dump_estimation( out, rhs.ipc, z);
+    out << std::endl << "sampled mispredict:  ";
+    dump_estimation( out, rhs.mispredict_rate, z);
+    out << std::endl << "sampled icache miss: ";
+    dump_estimation( out, rhs.icache_miss_rate, z);
+    return out << std::endl << "****************************" << std::endl;
+}
@@ -0,0 +1,84 @@
+/*
+ * sampling.h - statistical sampling of performance simulation
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <infra/types.h>
+
+#include <iosfwd>
+
+// Cumulative counters of performance simulator
+struct PerfStatistics
+{
+    uint64 instrs = 0;
+    uint64 cycles = 0;
+    uint64 jumps = 0;
+    uint64 mispredictions = 0;
+    uint64 icache_accesses = 0;
+    uint64 icache_misses = 0;
+
+    PerfStatistics operator-( const PerfStatistics& rhs) const
+    {
+        return { instrs - rhs.instrs, cycles - rhs.cycles, jumps - rhs.jumps, mispredictions - rhs.mispredictions,
+                 icache_accesses - rhs.icache_accesses, icache_misses - rhs.icache_misses };
+    }
+};
+
+/*
+ * SMARTS-like sampling: each period starts with functional fast-forward,
+ * which warms up caches and branch predictors, continues with detailed warm-up
+ * of the pipeline, and ends with a measured detailed window.
+ */
+struct SamplingParameters
+{
+    uint64 period = 0; // zero disables sampling
+    uint64 warm_up = 2000;
+    uint64 window = 1000;
+    // Sampling stops when the confidence interval of IPC is narrower than target_error * mean
+    double target_error = 0.03;
+    // Quantile of the normal distribution, 3 is 99.7% confidence level
+    double confidence_z = 3;
+    uint64 min_samples = 30;
+
+    bool is_enabled() const { return period != 0; }
+
+    static SamplingParameters create_configured();
+};
+
+// Running mean and variance of a sampled metric
+class SampleEstimator
+{
+public:
+    void add( double value);
+
+    auto get_count() const { return count; }
+    auto get_mean() const { return mean; }
+    double get_variance() const;
+
+    // Half-width of the confidence interval of the mean, infinite if there are less than two samples
+    double get_half_width( double z) const;
+    double get_relative_error( double z) const;
+
+private:
+    uint64 count = 0;
+    double mean = 0;
+    double m2 = 0;
+};
+
+struct SamplingReport
+{
+    SampleEstimator ipc;
+    SampleEstimator mispredict_rate;
+    SampleEstimator icache_miss_rate;
+    double confidence_z = 3;
+
+    void add( const PerfStatistics& window);
+    bool is_accurate( const SamplingParameters& params) const;
+
+    friend std::ostream& operator<<( std::ostream& out, const SamplingReport& rhs);
+};
+
+#endif // SAMPLING_H
@@ -5,10 +5,17 @@
 
 #include <catch.hpp>
 
+#include <infra/config/config.h>
 #include <kernel/kernel.h>
+#include <mips/mips.h>
+#include <modules/core/hybrid_sim.h>
 #include <modules/core/perf_sim.h>
 #include <modules/writeback/writeback.h>
 
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
 static auto init( const std::string& isa)
 {
     // Just call a constructor
@@ -131,22 +138,27 @@ TEST_CASE( "Perf_Sim: Register size")
     CHECK( CycleAccurateSimulator::create_simulator( "mips64")->sizeof_register() == bytewidth<uint64>);
 }
 
-static auto create_mars_sim( const std::string& isa, const std::string& binary_name, std::istream& kernel_in, std::ostream& kernel_out, bool has_hooks)
+static void load_mars_program( const std::shared_ptr<Simulator>& sim, const std::shared_ptr<FuncMemory>& mem,
+                               const std::string& binary_name, std::istream& kernel_in, std::ostream& kernel_out)
 {
-    auto sim = CycleAccurateSimulator::create_simulator( isa);
-    auto mem = FuncMemory::create_default_hierarchied_memory();
-    sim->set_memory( mem);
-
     auto kernel = Kernel::create_kernel( true, kernel_in, kernel_out, std::cerr);
     kernel->set_simulator( sim);
     kernel->connect_memory( mem);
     kernel->connect_exception_handler();
     kernel->load_file( binary_name);
     sim->set_kernel( kernel);
+    sim->set_pc( kernel->get_start_pc());
+}
+
+static auto create_mars_sim( const std::string& isa, const std::string& binary_name, std::istream& kernel_in, std::ostream& kernel_out, bool has_hooks)
+{
+    auto sim = CycleAccurateSimulator::create_simulator( isa);
+    auto mem = FuncMemory::create_default_hierarchied_memory();
+    sim->set_memory( mem);
+    load_mars_program( sim, mem, binary_name, kernel_in, kernel_out);
     if ( has_hooks)
         sim->enable_driver_hooks();
 
-    sim->set_pc( kernel->get_start_pc());
     return sim;
 }
 
@@ -172,6 +184,333 @@ TEST_CASE( "Torture_Test: Perf_Sim, MARS 32, Core Universal hooked")
     CHECK( sim->get_exit_code() == 0);
 }
 
+static auto create_hybrid_sim( const std::string& binary_name, std::istream& kernel_in, std::ostream& kernel_out, uint64 fast_forward,
+                               const SamplingParameters& sampling = {})
+{
+    auto sim = Simulator::create_hybrid_simulator( "mars", fast_forward, sampling);
+    auto mem = FuncMemory::create_default_hierarchied_memory();
+    sim->set_memory( mem);
+
+    auto kernel = Kernel::create_kernel( true, kernel_in, kernel_out, std::cerr);
+    kernel->set_simulator( sim);
+    kernel->connect_memory( mem);
+    kernel->connect_exception_handler();
+    kernel->load_file( binary_name);
+    sim->set_kernel( kernel);
+
+    sim->set_pc( kernel->get_start_pc());
+    return sim;
+}
+
+TEST_CASE( "Torture_Test: Hybrid_Sim, MARS 32, fast-forward and switch")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto sim = create_hybrid_sim( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout, 1000);
+    const auto* hybrid = dynamic_cast<const HybridSim<MARS>*>( sim.get());
+    REQUIRE( hybrid != nullptr);
+    CHECK( hybrid->is_fast_forwarding());
+
+    CHECK( run_silent( sim, 400) == Trap::BREAKPOINT);
+    CHECK( hybrid->is_fast_forwarding());
+
+    // Checker of performance simulator validates the handed over state
+    CHECK( run_silent( sim) == Trap::HALT);
+    CHECK_FALSE( hybrid->is_fast_forwarding());
+    CHECK( sim->get_exit_code() == 0);
+}
+
+TEST_CASE( "Torture_Test: Hybrid_Sim, MARS 32, fast-forward to the end")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto sim = create_hybrid_sim( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout, MAX_VAL64);
+    CHECK( run_silent( sim) == Trap::HALT);
+    CHECK( dynamic_cast<const HybridSim<MARS>*>( sim.get())->is_fast_forwarding());
+}
+
+TEST_CASE( "Torture_Test: Hybrid_Sim, MARS 32, no fast-forward")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto sim = create_hybrid_sim( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout, 0);
+    CHECK( run_silent( sim) == Trap::HALT);
+    CHECK_FALSE( dynamic_cast<const HybridSim<MARS>*>( sim.get())->is_fast_forwarding());
+    CHECK( sim->get_sampling_report() == nullptr);
+}
+
+TEST_CASE( "Torture_Test: Hybrid_Sim, MIPS 32, switch in a delay slot")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto funcsim = Simulator::create_functional_simulator( "mips32");
+    auto funcsim_mem = FuncMemory::create_default_hierarchied_memory();
+    funcsim->set_memory( funcsim_mem);
+    auto funcsim_kernel = Kernel::create_kernel( true, nullin, nullout, std::cerr);
+    funcsim_kernel->set_simulator( funcsim);
+    funcsim_kernel->connect_memory( funcsim_mem);
+    funcsim_kernel->connect_exception_handler();
+    funcsim_kernel->load_file( TEST_PATH "/mips/mips-tt.bin");
+    funcsim->set_kernel( funcsim_kernel);
+    funcsim->set_pc( funcsim_kernel->get_start_pc());
+    uint64 fast_forward = 0;
+    do {
+        REQUIRE( funcsim->run( 1) == Trap::BREAKPOINT);
+        ++fast_forward;
+    } while ( funcsim->get_target().valid);
+
+    auto sim = Simulator::create_hybrid_simulator( "mips32", fast_forward);
+    auto mem = FuncMemory::create_default_hierarchied_memory();
+    sim->set_memory( mem);
+    auto kernel = Kernel::create_kernel( true, nullin, nullout, std::cerr);
+    kernel->set_simulator( sim);
+    kernel->connect_memory( mem);
+    kernel->connect_exception_handler();
+    kernel->load_file( TEST_PATH "/mips/mips-tt.bin");
+    sim->set_kernel( kernel);
+    sim->set_pc( kernel->get_start_pc());
+    const auto* hybrid = dynamic_cast<const HybridSim<MIPS32>*>( sim.get());
+    REQUIRE( hybrid != nullptr);
+
+    CHECK( run_silent( sim, fast_forward) == Trap::BREAKPOINT);
+    CHECK( hybrid->is_fast_forwarding());
+
+    // The delay slot is the only instruction to run
+    CHECK( run_silent( sim, 1) == Trap::BREAKPOINT);
+    CHECK_FALSE( hybrid->is_fast_forwarding());
+
+    // Performance simulator does not execute delayed branches, so only the handed over target is checked
+    CHECK( funcsim->run( 1) == Trap::BREAKPOINT);
+    CHECK( sim->get_target().address == funcsim->get_target().address);
+}
+
+TEST_CASE( "Sampling: estimator")
+{
+    SampleEstimator estimator;
+    estimator.add( 2);
+    CHECK( estimator.get_count() == 1);
+    CHECK( estimator.get_mean() == 2);
+    CHECK( std::isinf( estimator.get_half_width( 3)));
+
+    estimator.add( 4);
+    estimator.add( 6);
+    CHECK( estimator.get_mean() == 4);
+    CHECK( estimator.get_variance() == 4);
+    CHECK( estimator.get_half_width( 3) == Approx( 3 * 2 / std::sqrt( 3)));
+    CHECK( estimator.get_relative_error( 3) == Approx( 3 * 2 / std::sqrt( 3) / 4));
+}
+
+TEST_CASE( "Sampling: report")
+{
+    SamplingParameters params;
+    params.min_samples = 2;
+    params.target_error = 0.5;
+
+    SamplingReport report;
+    report.add( PerfStatistics{ 100, 200, 10, 1, 100, 5});
+    CHECK_FALSE( report.is_accurate( params));
+    report.add( PerfStatistics{ 100, 200, 0, 0, 100, 5});
+    CHECK( report.is_accurate( params));
+    CHECK( report.ipc.get_mean() == 0.5);
+    CHECK( report.mispredict_rate.get_count() == 1);
+    CHECK( report.icache_miss_rate.get_mean() == Approx( 0.05));
+}
+
+TEST_CASE( "Torture_Test: Hybrid_Sim, MARS 32, sampling")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    SamplingParameters params;
+    params.period = 300;
+    params.warm_up = 50;
+    params.window = 100;
+    params.target_error = 0;
+    auto sim = create_hybrid_sim( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout, 100, params);
+    CHECK( run_silent( sim) == Trap::HALT);
+
+    REQUIRE( sim->get_sampling_report() != nullptr);
+    const auto& report = *sim->get_sampling_report();
+    CHECK( report.ipc.get_count() > 1);
+    CHECK( report.ipc.get_mean() > 0);
+    CHECK( report.ipc.get_mean() <= 1);
+}
+
+TEST_CASE( "Torture_Test: Hybrid_Sim, MARS 32, sampling stops when accurate")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    SamplingParameters params;
+    params.period = 300;
+    params.warm_up = 50;
+    params.window = 100;
+    params.min_samples = 2;
+    params.target_error = 1000;
+    auto sim = create_hybrid_sim( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout, 0, params);
+    CHECK( run_silent( sim) == Trap::BREAKPOINT);
+    REQUIRE( sim->get_sampling_report() != nullptr);
+    CHECK( sim->get_sampling_report()->ipc.get_count() == 2);
+}
+
+static uint64 count_cycles( const std::string& bp_mode)
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    const config::ScopedOverrides overrides( config::ScopedOverrides::Values{ { "bp-mode", bp_mode}});
+    auto sim = create_mars_sim( "mars", TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout, false);
+    sim->set_statistics_dump( false);
+    return sim->run_no_limit() == Trap::HALT ? sim->get_statistics().cycles : 0;
+}
+
+static PerfStatistics get_statistics( const std::string& isa, const std::string& binary, config::ScopedOverrides::Values values)
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    const config::ScopedOverrides overrides( std::move( values));
+    auto sim = create_mars_sim( isa, binary, nullin, nullout, false);
+    sim->set_statistics_dump( false);
+    CHECK( sim->run_no_limit() == Trap::HALT);
+    return sim->get_statistics();
+}
+
+TEST_CASE( "Perf_Sim: skipping idle cycles keeps statistics")
+{
+    const std::vector<config::ScopedOverrides::Values> configurations = {
+        { },
+        { { "icache-size", "256"}, { "icache-ways", "1"}},
+        { { "icache-size", "512"}, { "long-alu-latency", "20"}},
+    };
+    const std::vector<std::pair<std::string, std::string>> programs = {
+        { "mars", TEST_PATH "/mips/mips-tt-no-delayed-branches.bin"},
+        { "riscv32", TEST_PATH "/riscv/rv32ui-p-simple"},
+    };
+    for ( const auto& [isa, binary] : programs) {
+        for ( const auto& values : configurations) {
+            auto clocked_values = values;
+            clocked_values.emplace( "no-cycle-skipping", "true");
+            clocked_values.emplace( "no-clock-gating", "true");
+            const auto clocked = get_statistics( isa, binary, clocked_values);
+            for ( const auto* option : { "no-cycle-skipping", "no-clock-gating", "" }) {
+                auto skipped_values = values;
+                if ( *option != '\0')
+                    skipped_values.emplace( option, "true");
+                const auto skipped = get_statistics( isa, binary, skipped_values);
+                CHECK( skipped.cycles == clocked.cycles);
+                CHECK( skipped.instrs == clocked.instrs);
+                CHECK( skipped.jumps == clocked.jumps);
+                CHECK( skipped.mispredictions == clocked.mispredictions);
+                CHECK( skipped.icache_accesses == clocked.icache_accesses);
+                CHECK( skipped.icache_misses == clocked.icache_misses);
+            }
+        }
+    }
+}
+
+TEST_CASE( "PerfSim: skipping idle cycles keeps deadlock cycle")
+{
+    std::vector<uint64> cycles;
+    for ( const auto* value : { "false", "true"}) {
+        const config::ScopedOverrides overrides( config::ScopedOverrides::Values{ { "no-cycle-skipping", value}, { "no-clock-gating", value}});
+        auto m = FuncMemory::create_default_hierarchied_memory();
+        auto sim = CycleAccurateSimulator::create_simulator( "mips32");
+        sim->set_memory( m);
+        CHECK_THROWS_AS( sim->run_no_limit(), Deadlock);
+        cycles.push_back( sim->get_statistics().cycles);
+    }
+    CHECK( cycles[0] == cycles[1]);
+}
+
+TEST_CASE( "Perf_Sim: independent simulators on different threads")
+{
+    const std::vector<std::string> modes = { "always_taken", "always_not_taken", "backward_jumps",
+                                             "saturating_one_bit", "saturating_two_bits", "adaptive_two_levels" };
+    std::vector<uint64> expected;
+    for ( const auto& mode : modes)
+        expected.push_back( count_cycles( mode));
+    CHECK( expected.front() != expected.back());
+
+    std::vector<uint64> cycles( modes.size());
+    std::vector<std::thread> threads;
+    for ( size_t i = 0; i < modes.size(); ++i)
+        threads.emplace_back( [&cycles, &modes, i]() { cycles[i] = count_cycles( modes[i]); });
+    for ( auto& thread : threads)
+        thread.join();
+
+    CHECK( cycles == expected);
+    CHECK( std::find( cycles.begin(), cycles.end(), 0) == cycles.end());
+}
+
+TEST_CASE( "Perf_Sim: reset and run again")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto sim = create_mars_sim( "mars", TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout, false);
+    sim->set_statistics_dump( false);
+    CHECK( sim->run_no_limit() == Trap::HALT);
+    const auto expected = sim->get_statistics();
+
+    sim->reset();
+    CHECK( sim->get_statistics().cycles == 0);
+    CHECK( sim->get_executed_instrs() == 0);
+    CHECK( sim->read_cpu_register( 2) == 0);
+
+    // Predictors and caches are cold again, so the timing is the same as of a new simulator
+    auto mem = FuncMemory::create_default_hierarchied_memory();
+    sim->set_memory( mem);
+    load_mars_program( sim, mem, TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout);
+    CHECK( sim->run_no_limit() == Trap::HALT);
+    CHECK( sim->get_statistics().cycles == expected.cycles);
+    CHECK( sim->get_statistics().instrs == expected.instrs);
+    CHECK( sim->get_statistics().mispredictions == expected.mispredictions);
+    CHECK( sim->get_statistics().icache_misses == expected.icache_misses);
+
+    // The same memory is reused for the next image, checker validates the run
+    sim->reset();
+    load_mars_program( sim, mem, TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout);
+    CHECK( sim->run_no_limit() == Trap::HALT);
+    CHECK( sim->get_statistics().instrs == expected.instrs);
+}
+
+TEST_CASE( "Func_Sim: reset and run again")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto sim = Simulator::create_functional_simulator( "mars");
+    auto mem = FuncMemory::create_default_hierarchied_memory();
+    sim->set_memory( mem);
+    load_mars_program( sim, mem, TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout);
+    CHECK( run_silent( sim) == Trap::HALT);
+    const auto expected = sim->get_executed_instrs();
+
+    sim->reset();
+    CHECK( sim->get_executed_instrs() == 0);
+    load_mars_program( sim, mem, TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout);
+    CHECK( run_silent( sim) == Trap::HALT);
+    CHECK( sim->get_executed_instrs() == expected);
+}
+
+TEST_CASE( "Torture_Test: Hybrid_Sim, MARS 32, reset and fast-forward again")
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto sim = Simulator::create_hybrid_simulator( "mars", 1000);
+    auto mem = FuncMemory::create_default_hierarchied_memory();
+    sim->set_memory( mem);
+    load_mars_program( sim, mem, TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout);
+    const auto* hybrid = dynamic_cast<const HybridSim<MARS>*>( sim.get());
+    REQUIRE( hybrid != nullptr);
+    CHECK( run_silent( sim) == Trap::HALT);
+    CHECK_FALSE( hybrid->is_fast_forwarding());
+    const auto expected = sim->get_executed_instrs();
+
+    sim->reset();
+    CHECK( hybrid->is_fast_forwarding());
+    CHECK( sim->get_executed_instrs() == 0);
+    load_mars_program( sim, mem, TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout);
+    CHECK( run_silent( sim) == Trap::HALT);
+    CHECK_FALSE( hybrid->is_fast_forwarding());
+    CHECK( sim->get_executed_instrs() == expected);
+}
+
 TEST_CASE( "Perf_Sim: Run_SMC_Trace_WithChecker")
 {
     std::istream nullin( nullptr);
@@ -179,6 +518,56 @@ TEST_CASE( "Perf_Sim: Run_SMC_Trace_WithChecker")
     CHECK_THROWS_AS( create_mars_sim( "mars", TEST_PATH "/mips/mips-smc.bin", nullin, nullout, false)->run_no_limit(), CheckerMismatch);
 }
 
+static std::string get_checker_mismatch( const config::ScopedOverrides::Values& values)
+{
+    const config::ScopedOverrides overrides( values);
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto sim = create_mars_sim( "mars", TEST_PATH "/mips/mips-smc.bin", nullin, nullout, false);
+    try {
+        sim->run_no_limit();
+    }
+    catch ( const CheckerMismatch& e) {
+        return e.what();
+    }
+    return {};
+}
+
+static std::string get_line( const std::string& text, std::string_view prefix)
+{
+    const auto begin = text.find( prefix);
+    return begin == std::string::npos ? std::string() : text.substr( begin, text.find( '\n', begin) - begin);
+}
+
+TEST_CASE( "Perf_Sim: Run_SMC_Trace_WithChecker, same mismatch on simulation thread")
+{
+    const auto async_mismatch = get_checker_mismatch( { { "sync-checker", "false"}});
+    CHECK( async_mismatch.find( "Writeback cycle: ") != std::string::npos);
+    CHECK( async_mismatch == get_checker_mismatch( { { "sync-checker", "true"}}));
+}
+
+TEST_CASE( "Perf_Sim: Run_SMC_Trace_WithChecker, state hashes")
+{
+    const auto mismatch = get_checker_mismatch( {});
+    for ( const auto* interval : { "1", "7", "1000"}) {
+        for ( const auto* sync : { "false", "true"}) {
+            const auto hash_mismatch = get_checker_mismatch( { { "checker-hash-interval", interval}, { "sync-checker", sync}});
+            CHECK( get_line( hash_mismatch, "Checker output: ") == get_line( mismatch, "Checker output: "));
+            CHECK( get_line( hash_mismatch, "Writeback cycle: ") == get_line( mismatch, "Writeback cycle: "));
+        }
+    }
+}
+
+TEST_CASE( "Torture_Test: Perf_Sim, MARS 32, state hash checker")
+{
+    const config::ScopedOverrides overrides( config::ScopedOverrides::Values{ { "checker-hash-interval", "64"}});
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto sim = create_mars_sim( "mars", TEST_PATH "/mips/mips-tt-no-delayed-branches.bin", nullin, nullout, false);
+    CHECK( run_silent( sim) == Trap::HALT);
+    CHECK( sim->get_exit_code() == 0);
+}
+
 TEST_CASE( "Perf_Sim: Run_SMC_Trace_WithoutChecker")
 {
     std::istream nullin( nullptr);
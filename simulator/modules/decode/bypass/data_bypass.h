@@ -66,6 +66,12 @@ class DataBypass
         // updates the scoreboard
         void update() noexcept;
 
+        // checks whether updates would not change the scoreboard
+        bool is_idle() const noexcept
+        {
+            return traced_count == 0 && writeback_stage_info.operation_latency == 0_lt;
+        }
+
         // handles a flush of the pipeline
         void handle_flush() noexcept;
 
@@ -124,6 +130,21 @@ class DataBypass
         std::array<RegisterInfo, Register::MAX_REG> scoreboard = {};
         FuncUnitInfo writeback_stage_info = {};
 
+        // Indices of traced scoreboard entries, so per-cycle work depends on instructions in flight only
+        static_assert( Register::MAX_REG <= MAX_VAL16);
+        std::array<uint16, Register::MAX_REG> traced_registers = {};
+        size_t traced_count = 0;
+
+        void start_tracing( Register num, RegisterInfo* entry) noexcept
+        {
+            if ( entry->is_traced)
+                return;
+
+            entry->is_traced = true;
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index) Each register is listed once
+            traced_registers[ traced_count++] = narrow_cast<uint16>( num.to_rf_index());
+        }
+
         RegisterInfo& get_entry( Register num) noexcept
         {
             auto idx = num.to_rf_index();
@@ -191,7 +212,7 @@ void DataBypass<FuncInstr>::trace_new_dst_register( const Instr& instr, Register
 
 
     entry.is_bypassible = ( entry.current_stage == entry.ready_stage);
-    entry.is_traced = true;
+    start_tracing( num, &entry);
 }
 
 template <typename FuncInstr>
@@ -205,7 +226,7 @@ void DataBypass<FuncInstr>::trace_new_dst2_register( const Instr& instr, Registe
     // values of registers used for the 2nd destination cannot be bypassed
     entry.ready_stage.set_to_in_RF();
 
-    entry.is_traced = true;
+    start_tracing( num, &entry);
 }
 
 template <typename FuncInstr>
@@ -226,16 +247,19 @@ void DataBypass<FuncInstr>::trace_new_instr( const Instr& instr) noexcept
 template <typename FuncInstr>
 void DataBypass<FuncInstr>::update() noexcept
 {
-    for ( auto& entry:scoreboard)
+    for ( size_t i = 0; i < traced_count; )
     {
-        if ( !entry.is_traced)
-            continue;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index) Guaranteed
+        auto& entry = scoreboard[ traced_registers[ i]];
 
         if ( entry.current_stage.is_writeback())
         {
             entry.reset();
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index) Guaranteed
+            traced_registers[ i] = traced_registers[ --traced_count];
             continue;
         }
+        ++i;
 
         if ( entry.current_stage.is_first_execution_stage())
             entry.current_stage = entry.next_stage_after_first_execution_stage;
@@ -254,9 +278,10 @@ void DataBypass<FuncInstr>::update() noexcept
 template <typename FuncInstr>
 void DataBypass<FuncInstr>::handle_flush() noexcept
 {
-    for ( auto& entry:scoreboard)
-        if ( entry.is_traced)
-            entry.reset();
+    for ( size_t i = 0; i < traced_count; ++i)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index) Guaranteed
+        scoreboard[ traced_registers[ i]].reset();
+    traced_count = 0;
 
     writeback_stage_info.operation_latency = 0_lt;
 }
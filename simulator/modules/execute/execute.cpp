@@ -16,23 +16,29 @@ template <typename FuncInstr>
 Execute<FuncInstr>::Execute( Module* parent) : Module( parent, "execute")
     , last_execution_stage_latency( Latency( config::long_alu_latency - 1))
 {
-    rps_bypass[0].command_port = make_read_port<BypassCommand>("DECODE_2_EXECUTE_SRC1_COMMAND", Port::LATENCY);
-    rps_bypass[1].command_port = make_read_port<BypassCommand>("DECODE_2_EXECUTE_SRC2_COMMAND", Port::LATENCY);
+    rps_bypass[0].command_port = make_read_port( Ports::DECODE_2_EXECUTE_SRC1_COMMAND, Port::LATENCY);
+    rps_bypass[1].command_port = make_read_port( Ports::DECODE_2_EXECUTE_SRC2_COMMAND, Port::LATENCY);
 
-    rps_bypass[0].data_ports[0] = make_read_port<InstructionOutput>("EXECUTE_2_EXECUTE_BYPASS", Port::LATENCY);
-    rps_bypass[1].data_ports[0] = make_read_port<InstructionOutput>("EXECUTE_2_EXECUTE_BYPASS", Port::LATENCY);
+    rps_bypass[0].data_ports[0] = make_read_port( Ports::EXECUTE_2_EXECUTE_BYPASS, Port::LATENCY);
+    rps_bypass[1].data_ports[0] = make_read_port( Ports::EXECUTE_2_EXECUTE_BYPASS, Port::LATENCY);
 
-    rps_bypass[0].data_ports[1] = make_read_port<InstructionOutput>("EXECUTE_COMPLEX_ALU_2_EXECUTE_BYPASS", Port::LATENCY);
-    rps_bypass[1].data_ports[1] = make_read_port<InstructionOutput>("EXECUTE_COMPLEX_ALU_2_EXECUTE_BYPASS", Port::LATENCY);
+    rps_bypass[0].data_ports[1] = make_read_port( Ports::EXECUTE_COMPLEX_ALU_2_EXECUTE_BYPASS, Port::LATENCY);
+    rps_bypass[1].data_ports[1] = make_read_port( Ports::EXECUTE_COMPLEX_ALU_2_EXECUTE_BYPASS, Port::LATENCY);
 
-    rps_bypass[0].data_ports[2] = make_read_port<InstructionOutput>("MEMORY_2_EXECUTE_BYPASS", Port::LATENCY);
-    rps_bypass[1].data_ports[2] = make_read_port<InstructionOutput>("MEMORY_2_EXECUTE_BYPASS", Port::LATENCY);
+    rps_bypass[0].data_ports[2] = make_read_port( Ports::MEMORY_2_EXECUTE_BYPASS, Port::LATENCY);
+    rps_bypass[1].data_ports[2] = make_read_port( Ports::MEMORY_2_EXECUTE_BYPASS, Port::LATENCY);
 
-    rps_bypass[0].data_ports[3] = make_read_port<InstructionOutput>("WRITEBACK_2_EXECUTE_BYPASS", Port::LATENCY);
-    rps_bypass[1].data_ports[3] = make_read_port<InstructionOutput>("WRITEBACK_2_EXECUTE_BYPASS", Port::LATENCY);
+    rps_bypass[0].data_ports[3] = make_read_port( Ports::WRITEBACK_2_EXECUTE_BYPASS, Port::LATENCY);
+    rps_bypass[1].data_ports[3] = make_read_port( Ports::WRITEBACK_2_EXECUTE_BYPASS, Port::LATENCY);
 
-    rps_bypass[0].data_ports[4] = make_read_port<InstructionOutput>("BRANCH_2_EXECUTE_BYPASS", Port::LATENCY);
-    rps_bypass[1].data_ports[4] = make_read_port<InstructionOutput>("BRANCH_2_EXECUTE_BYPASS", Port::LATENCY);
+    rps_bypass[0].data_ports[4] = make_read_port( Ports::BRANCH_2_EXECUTE_BYPASS, Port::LATENCY);
+    rps_bypass[1].data_ports[4] = make_read_port( Ports::BRANCH_2_EXECUTE_BYPASS, Port::LATENCY);
+
+    // Bypass ports are read only together with the datapath
+    add_wakeup_port( rp_datapath);
+    add_wakeup_port( rp_long_latency_execution_unit);
+    add_wakeup_port( rp_flush);
+    add_wakeup_port( rp_trap);
 }
 
 template <typename FuncInstr>
@@ -11,6 +11,7 @@
 #include <modules/core/perf_instr.h>
 #include <modules/decode/bypass/data_bypass_interface.h>
 #include <modules/ports_instance.h>
+#include <modules/ports_topology.h>
 
 namespace config {
     extern const PredicatedValue<uint64> long_alu_latency;
@@ -21,6 +22,7 @@ class Execute : public Module
 {
     using Register = typename FuncInstr::Register;
     using Instr = PerfInstr<FuncInstr>;
+    using Ports = PipelinePorts<FuncInstr>;
     using RegisterUInt = typename FuncInstr::RegisterUInt;
     using InstructionOutput = std::array< RegisterUInt, MAX_DST_NUM>;
 
@@ -29,10 +31,10 @@ class Execute : public Module
         const Latency last_execution_stage_latency;
 
         /* Inputs */
-        ReadPort<Instr>* rp_datapath = make_read_port<Instr>("DECODE_2_EXECUTE", Port::LATENCY);
-        ReadPort<Instr>* rp_long_latency_execution_unit = make_read_port<Instr>("EXECUTE_2_EXECUTE_LONG_LATENCY", last_execution_stage_latency);
-        ReadPort<bool>* rp_flush = make_read_port<bool>("BRANCH_2_ALL_FLUSH", Port::LATENCY);
-        ReadPort<bool>* rp_trap = make_read_port<bool>("WRITEBACK_2_ALL_FLUSH", Port::LATENCY);
+        ReadPort<Instr>* rp_datapath = make_read_port( Ports::DECODE_2_EXECUTE, Port::LATENCY);
+        ReadPort<Instr>* rp_long_latency_execution_unit = make_read_port( Ports::EXECUTE_2_EXECUTE_LONG_LATENCY, last_execution_stage_latency);
+        ReadPort<bool>* rp_flush = make_read_port( Ports::BRANCH_2_ALL_FLUSH, Port::LATENCY);
+        ReadPort<bool>* rp_trap = make_read_port( Ports::WRITEBACK_2_ALL_FLUSH, Port::LATENCY);
 
         struct BypassPorts {
             ReadPort<BypassCommand>* command_port;
@@ -41,12 +43,12 @@ class Execute : public Module
         std::array<BypassPorts, SRC_REGISTERS_NUM> rps_bypass;
 
         /* Outputs */
-        WritePort<Instr>* wp_mem_datapath = make_write_port<Instr>("EXECUTE_2_MEMORY" , Port::BW );
-        WritePort<Instr>* wp_branch_datapath = make_write_port<Instr>("EXECUTE_2_BRANCH" , Port::BW )   ;
-        WritePort<Instr>* wp_writeback_datapath =  make_write_port<Instr>("EXECUTE_2_WRITEBACK", Port::BW);
-        WritePort<Instr>* wp_long_latency_execution_unit = make_write_port<Instr>("EXECUTE_2_EXECUTE_LONG_LATENCY", Port::BW);
-        WritePort<InstructionOutput>* wp_bypass = make_write_port<InstructionOutput>("EXECUTE_2_EXECUTE_BYPASS", Port::BW);
-        WritePort<InstructionOutput>* wp_long_arithmetic_bypass = make_write_port<InstructionOutput>("EXECUTE_COMPLEX_ALU_2_EXECUTE_BYPASS", Port::BW);
+        WritePort<Instr>* wp_mem_datapath = make_write_port( Ports::EXECUTE_2_MEMORY, Port::BW );
+        WritePort<Instr>* wp_branch_datapath = make_write_port( Ports::EXECUTE_2_BRANCH, Port::BW )   ;
+        WritePort<Instr>* wp_writeback_datapath =  make_write_port( Ports::EXECUTE_2_WRITEBACK, Port::BW);
+        WritePort<Instr>* wp_long_latency_execution_unit = make_write_port( Ports::EXECUTE_2_EXECUTE_LONG_LATENCY, Port::BW);
+        WritePort<InstructionOutput>* wp_bypass = make_write_port( Ports::EXECUTE_2_EXECUTE_BYPASS, Port::BW);
+        WritePort<InstructionOutput>* wp_long_arithmetic_bypass = make_write_port( Ports::EXECUTE_COMPLEX_ALU_2_EXECUTE_BYPASS, Port::BW);
 
         Latency flush_expiration_latency = 0_lt;
 
@@ -61,6 +63,13 @@ class Execute : public Module
     public:
         explicit Execute( Module* parent);
         void clock( Cycle cycle);
+        void reset() { flush_expiration_latency = 0_lt; }
+        // Same as clocking the unit when none of its wakeup ports has data
+        void skip_idle_cycles( uint64 count)
+        {
+            const auto skipped = Latency( signify( count));
+            flush_expiration_latency = skipped < flush_expiration_latency ? flush_expiration_latency - skipped : 0_lt;
+        }
 };
 
 #endif // EXECUTE_H
@@ -12,6 +12,7 @@
 #include <infra/config/config.h>
 
 // C++ generic modules
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <sstream>
@@ -93,6 +94,16 @@ public:
         directions[ way][ set].update( bp_upd.is_taken);
         targets[ way][ set] = bp_upd.target;
     }
+
+    void reset() final
+    {
+        for ( auto& way : directions)
+            for ( auto& entry : way)
+                entry.reset();
+        for ( auto& way : targets)
+            std::fill( way.begin(), way.end(), Addr{});
+        tags->reset();
+    }
 };
 
 class BPFactory {
@@ -160,6 +171,7 @@ public:
 std::unique_ptr<BaseBP> BaseBP::create_bp( const std::string& name, const std::string& lru, 
                                            uint32 size_in_entries, uint32 ways, uint32 branch_ip_size_in_bits)
 {
+    // Immutable after construction, so predictors may be created from several threads
     static const BPFactory factory;
     return factory.create(name, lru, size_in_entries, ways, branch_ip_size_in_bits);
 }
@@ -39,6 +39,8 @@ public:
     virtual bool is_hit( Addr PC) const = 0;
     virtual Addr get_target( Addr PC) const = 0;
     virtual void update( const BPInterface& bp_upd) = 0;
+    // Forgets all branches, tables are kept allocated
+    virtual void reset() = 0;
 
     BPInterface get_bp_info( Addr PC) const
     {
@@ -24,6 +24,7 @@ Fetch<FuncInstr>::Fetch( Module* parent)
     : Module( parent, "fetch")
     , _fetchahead_size( config::fetchahead_distance)
     , _prefetch_method( config::prefetch_method)
+    , line_bits( std::countr_zero( uint32{ config::instruction_cache_line_size}))
 {
     bp = BaseBP::create_configured_bp();
     tags = CacheTagArray::create(
@@ -35,6 +36,19 @@ Fetch<FuncInstr>::Fetch( Module* parent)
     );
 }
 
+template <typename FuncInstr>
+void Fetch<FuncInstr>::reset()
+{
+    bp->reset();
+    tags->reset();
+    is_wrong_path = false;
+    is_miss_pending = false;
+    saved_target = Target();
+    last_warmed_line = NO_VAL64;
+    icache_accesses = 0;
+    icache_misses = 0;
+}
+
 template <typename FuncInstr>
 Target Fetch<FuncInstr>::get_target( Cycle cycle)
 {
@@ -102,9 +116,12 @@ void Fetch<FuncInstr>::clock_instr_cache( Cycle cycle)
 
         /* save PC to the next stage */
         wp_hold_pc->write( target, cycle);
-        return;
+        if ( saved_target.valid)
+            wp_target->write( saved_target, cycle);
+
+        is_miss_pending = false;
+        saved_target = Target();
     }
-    wp_hit_or_miss->write( false, cycle);
 }
 
 template <typename FuncInstr>
@@ -112,20 +129,18 @@ void Fetch<FuncInstr>::save_flush( Cycle cycle)
 {
     /* save PC in the case of flush signal */
     if( rp_flush_target->is_ready( cycle))
-        wp_target->write( rp_flush_target->read( cycle), cycle);
+        saved_target = rp_flush_target->read( cycle);
     else if( rp_flush_target_from_decode->is_ready( cycle))
-        wp_target->write( rp_flush_target_from_decode->read( cycle), cycle);
-    else if( rp_target->is_ready( cycle))
-        wp_target->write( rp_target->read( cycle), cycle);
-    else if( rp_external_target->is_ready( cycle))
-        wp_target->write( rp_external_target->read( cycle), cycle);
+        saved_target = rp_flush_target_from_decode->read( cycle);
+    else if( !saved_target.valid && rp_external_target->is_ready( cycle))
+        saved_target = rp_external_target->read( cycle);
 }
 
 template <typename FuncInstr>
 Target Fetch<FuncInstr>::get_cached_target( Cycle cycle)
 {
     /* simulate request to the memory in the case of cache miss */
-    if ( rp_hit_or_miss->is_ready( cycle))
+    if ( is_miss_pending)
     {
         save_flush( cycle);
         clock_instr_cache( cycle);
@@ -141,12 +156,15 @@ Target Fetch<FuncInstr>::get_cached_target( Cycle cycle)
 
     /* hit or miss */
     auto is_hit = tags->lookup( target.address);
+    ++icache_accesses;
 
     if ( is_hit)
         return target;
 
-    /* send miss to the next cycle */
-    wp_hit_or_miss->write( is_hit, cycle);
+    ++icache_misses;
+
+    /* wait for the memory from the next cycle */
+    is_miss_pending = true;
 
     /* send PC to cache*/
     wp_long_latency_pc_holder->write( target, cycle);
@@ -186,11 +204,31 @@ void Fetch<FuncInstr>::clock( Cycle cycle)
         prefetch_next_line( target.address);
 }
 
+template <typename FuncInstr>
+void Fetch<FuncInstr>::skip_idle_cycles()
+{
+    // Waiting for a cache miss does nothing, otherwise targets are multiplexed
+    if ( !is_miss_pending && _prefetch_method == "wrong-path")
+        is_wrong_path = false;
+}
+
+template <typename FuncInstr>
+void Fetch<FuncInstr>::warm_up( const FuncInstr& instr)
+{
+    // Sequential instructions of the same line would not change LRU state
+    const Addr line = instr.get_PC() >> line_bits;
+    if ( line != last_warmed_line && !tags->lookup( instr.get_PC()))
+        tags->write( instr.get_PC());
+    last_warmed_line = line;
+
+    if ( instr.is_jump())
+        bp->update( Instr( instr, BPInterface{}).get_bp_upd());
+}
+
 template<typename FuncInstr>
 void Fetch<FuncInstr>::prefetch_next_line( Addr requested_addr)
 {
-    uint32 line_size( config::instruction_cache_line_size); // line size
-    size_t line_bits = std::countr_zero( line_size); // number of offset bits
+    Addr line_size = Addr{ 1} << line_bits; // line size
 
     Addr addr_mask = bitmask<Addr>( line_bits); // bit mask to extract the offset value
     Addr offset = requested_addr & addr_mask; // offset
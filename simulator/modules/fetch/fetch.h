@@ -12,11 +12,13 @@
 #include <infra/cache/cache_tag_array.h>
 #include <modules/core/perf_instr.h>
 #include <modules/ports_instance.h>
+#include <modules/ports_topology.h>
  
 template <typename FuncInstr>
 class Fetch : public Module
 {
     using Instr = PerfInstr<FuncInstr>;
+    using Ports = PipelinePorts<FuncInstr>;
 
 public:
     explicit Fetch( Module* parent);
@@ -26,35 +28,42 @@ public:
         memory = std::move( mem);
     }
 
+    // Trains branch predictor and instruction cache with an instruction executed by functional simulator
+    void warm_up( const FuncInstr& instr);
+    void reset();
+    // Same as clocking the unit when none of its ports has data
+    void skip_idle_cycles();
+
+    auto get_icache_accesses() const { return icache_accesses; }
+    auto get_icache_misses() const { return icache_misses; }
+
 private:
     std::unique_ptr<InstrMemoryIface<FuncInstr>> memory = nullptr;
     std::unique_ptr<BaseBP> bp = nullptr;
     std::unique_ptr<CacheTagArray> tags = nullptr;
     
     /* Input signals */
-    ReadPort<bool>* rp_stall = make_read_port<bool>("DECODE_2_FETCH_STALL", Port::LATENCY);
-    ReadPort<bool>* rp_hit_or_miss = make_read_port<bool>("HIT_OR_MISS", Port::LATENCY);
+    ReadPort<bool>* rp_stall = make_read_port( Ports::DECODE_2_FETCH_STALL, Port::LATENCY);
 
     /* Input signals - BP */
-    ReadPort<BPInterface>* rp_bp_update = make_read_port<BPInterface>("BRANCH_2_FETCH", Port::LATENCY);
-    ReadPort<BPInterface>* rp_bp_update_from_decode = make_read_port<BPInterface>("DECODE_2_FETCH", Port::LATENCY);
+    ReadPort<BPInterface>* rp_bp_update = make_read_port( Ports::BRANCH_2_FETCH, Port::LATENCY);
+    ReadPort<BPInterface>* rp_bp_update_from_decode = make_read_port( Ports::DECODE_2_FETCH, Port::LATENCY);
     
     /* Input signals - PC values */
-    ReadPort<Target>* rp_flush_target = make_read_port<Target>("BRANCH_2_FETCH_TARGET", Port::LATENCY);
-    ReadPort<Target>* rp_external_target = make_read_port<Target>("WRITEBACK_2_FETCH_TARGET", Port::LATENCY);
-    ReadPort<Target>* rp_hold_pc = make_read_port<Target>("HOLD_PC", Port::LATENCY);
-    ReadPort<Target>* rp_target = make_read_port<Target>("TARGET", Port::LATENCY);
-    ReadPort<Target>* rp_long_latency_pc_holder = make_read_port<Target>("LONG_LATENCY_PC_HOLDER", Port::LONG_LATENCY);
+    ReadPort<Target>* rp_flush_target = make_read_port( Ports::BRANCH_2_FETCH_TARGET, Port::LATENCY);
+    ReadPort<Target>* rp_external_target = make_read_port( Ports::WRITEBACK_2_FETCH_TARGET, Port::LATENCY);
+    ReadPort<Target>* rp_hold_pc = make_read_port( Ports::HOLD_PC, Port::LATENCY);
+    ReadPort<Target>* rp_target = make_read_port( Ports::TARGET, Port::LATENCY);
+    ReadPort<Target>* rp_long_latency_pc_holder = make_read_port( Ports::LONG_LATENCY_PC_HOLDER, Port::LONG_LATENCY);
 
     /* Outputs */
-    WritePort<Instr>* wp_datapath = make_write_port<Instr>("FETCH_2_DECODE", Port::BW);
-    WritePort<Target>* wp_hold_pc = make_write_port<Target>("HOLD_PC", Port::BW);
-    WritePort<Target>* wp_target = make_write_port<Target>("TARGET", Port::BW);
-    WritePort<Target>* wp_long_latency_pc_holder = make_write_port<Target>("LONG_LATENCY_PC_HOLDER", Port::BW);
-    WritePort<bool>* wp_hit_or_miss = make_write_port<bool>("HIT_OR_MISS", Port::BW);
+    WritePort<Instr>* wp_datapath = make_write_port( Ports::FETCH_2_DECODE, Port::BW);
+    WritePort<Target>* wp_hold_pc = make_write_port( Ports::HOLD_PC, Port::BW);
+    WritePort<Target>* wp_target = make_write_port( Ports::TARGET, Port::BW);
+    WritePort<Target>* wp_long_latency_pc_holder = make_write_port( Ports::LONG_LATENCY_PC_HOLDER, Port::BW);
 
     /* port needed for handling misprediction at decode stage */
-    ReadPort<Target>* rp_flush_target_from_decode = make_read_port<Target>("DECODE_2_FETCH_TARGET", Port::LATENCY);
+    ReadPort<Target>* rp_flush_target_from_decode = make_read_port( Ports::DECODE_2_FETCH_TARGET, Port::LATENCY);
 
     Target get_target( Cycle cycle);
     Target get_cached_target( Cycle cycle);
@@ -62,11 +71,25 @@ private:
     void clock_instr_cache( Cycle cycle);
     void save_flush( Cycle cycle);
 
+    /*
+     * Instruction cache miss is in progress, so fetch just waits for LONG_LATENCY_PC_HOLDER.
+     * A target received meanwhile is kept here rather than being passed through a port
+     * every cycle, so the miss leaves no data in ports and may be skipped over.
+     */
+    bool is_miss_pending = false;
+    Target saved_target;
+
     uint32 _fetchahead_size; // value of fetchahead distance size
     std::string _prefetch_method; // value of prefetch method
 
     bool is_wrong_path = false;
     void prefetch_next_line(Addr requested_addr);
+
+    const size_t line_bits;
+    Addr last_warmed_line = NO_VAL64;
+
+    uint64 icache_accesses = 0;
+    uint64 icache_misses = 0;
 };
 
 struct PrefetchMethodException final : Exception
@@ -9,7 +9,8 @@
 template <typename FuncInstr>
 Mem<FuncInstr>::Mem( Module* parent) : Module( parent, "mem")
 {
-
+    // Flush only drops the instruction, so the stage is idle without it
+    add_wakeup_port( rp_datapath);
 }
 
 template <typename FuncInstr>
@@ -0,0 +1,53 @@
+/*
+ * ports_topology.h - ports connecting modules of the performance simulator
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef PORTS_TOPOLOGY_H
+#define PORTS_TOPOLOGY_H
+
+#include <func_sim/operation.h>
+#include <infra/ports/ports.h>
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+struct BPInterface;
+class Target;
+class Trap;
+class BypassCommand;
+template<typename T> class PerfInstr;
+
+/*
+ * Each port of the pipeline is declared once in ports_topology.def with the type of its data.
+ * Modules create both sides of a port from the same key,
+ * so a writer and a reader of different types do not compile.
+ * Tests and examples may still connect ports by plain string names.
+ */
+template<typename FuncInstr>
+struct PipelinePorts
+{
+    using Instr = PerfInstr<FuncInstr>;
+    using InstructionOutput = std::array<typename FuncInstr::RegisterUInt, MAX_DST_NUM>;
+
+#define PORT( type, key) static constexpr PortKey<type> key = { #key};
+#include "ports_topology.def"
+#undef PORT
+};
+
+// Two keys with the same name would be connected whatever their types are
+template<typename FuncInstr>
+consteval bool has_unique_port_names()
+{
+    using P = PipelinePorts<FuncInstr>;
+    std::array names = {
+#define PORT( type, key) P::key.name,
+#include "ports_topology.def"
+#undef PORT
+    };
+    std::sort( names.begin(), names.end());
+    return std::adjacent_find( names.begin(), names.end()) == names.end();
+}
+
+#endif // PORTS_TOPOLOGY_H
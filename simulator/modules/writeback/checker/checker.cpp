@@ -5,41 +5,257 @@
  */
 
 #include "checker.h"
+#include <infra/config/config.h>
 #include <kernel/kernel.h>
 
 #include <sstream>
+#include <utility>
+
+namespace config {
+    static const Switch sync_checker = { "sync-checker", "check instructions on the simulation thread to stop right at a mismatch"};
+    static const Value<uint64> checker_hash_interval = { "checker-hash-interval", 0,
+        "compare hashes of committed state every N instructions instead of each instruction, zero disables hashing"};
+} // namespace config
+
+// Enough to hide hiccups of the checker thread, small enough to report a mismatch soon
+static constexpr size_t CHECKER_QUEUE_CAPACITY = 1024;
+
+// Number of instructions to replay at most, rare snapshots keep copying of page tables cheap
+static constexpr size_t CHECKER_REPLAY_PERIOD = 1ULL << 16U;
+
+template<typename T>
+static uint64 mix_hash( uint64 hash, const T& value)
+{
+    if constexpr ( bitwidth<T> > bitwidth<uint64>) {
+        for ( const auto part : unpack_to<uint64>( value))
+            hash = mix_hash( hash, part);
+        return hash;
+    }
+    else {
+        // Multiplicative step of splitmix64, a difference in any bit of the value changes the whole hash
+        hash = ( hash ^ narrow_cast<uint64>( value)) * 0x9e37'79b9'7f4a'7c15ULL;
+        return hash ^ ( hash >> 29U);
+    }
+}
+
+template<typename FuncInstr>
+static uint64 hash_instruction( uint64 hash, const FuncInstr& instr)
+{
+    hash = mix_hash( hash, instr.get_PC());
+    hash = mix_hash( hash, instr.get_bytes());
+    hash = mix_hash( hash, instr.get_sequence_id());
+    for ( size_t i = 0; i < MAX_DST_NUM; ++i)
+        if ( !instr.get_dst( i).is_zero())
+            hash = mix_hash( hash, instr.get_v_dst( i));
+    if ( instr.is_store()) {
+        hash = mix_hash( hash, instr.get_mem_addr());
+        hash = mix_hash( hash, instr.get_v_src( 1));
+    }
+    return hash;
+}
+
+template <ISA I>
+Checker<I>::Checker()
+    : hash_interval( config::checker_hash_interval)
+    , is_async( !config::sync_checker)
+    , queue( is_async ? CHECKER_QUEUE_CAPACITY : 1)
+{ }
+
+template <ISA I>
+Checker<I>::~Checker()
+{
+    stop();
+}
 
 template <ISA I>
 void Checker<I>::init( std::endian endian, Kernel* kernel, std::string_view isa)
 {
-    auto memory = FuncMemory::create_default_hierarchied_memory();
+    reset();
+    this->endian = endian;
+    this->isa = isa;
     sim = std::make_shared<FuncSim<I>>( endian, false, isa);
+    if ( is_async) {
+        // Snapshot shares pages copy-on-write, and the page ownership is not synchronized between threads
+        memory = FuncMemory::create_default_hierarchied_memory();
+        kernel->add_replica_memory( memory);
+    }
+    else {
+        memory = kernel->create_replica_memory();
+    }
     sim->set_memory( memory);
     kernel->add_replica_simulator( sim);
-    kernel->add_replica_memory( memory);
     active = true;
+    if ( is_async)
+        start();
+}
+
+template <ISA I>
+void Checker<I>::disable()
+{
+    stop();
+    active = false;
+}
+
+template <ISA I>
+void Checker<I>::reset()
+{
+    stop();
+    sim = nullptr;
+    memory = nullptr;
+    active = false;
+    perf_interval = {};
+    perf_hash = 0;
+    checker_hash = 0;
+    replay_start = std::nullopt;
+    posted_events = 0;
+    processed_events = 0;
+    has_error = false;
+    error = nullptr;
+}
+
+template <ISA I>
+void Checker<I>::start()
+{
+    thread = std::thread( [this]() { work(); });
+}
+
+template <ISA I>
+void Checker<I>::stop()
+{
+    if ( !thread.joinable())
+        return;
+
+    queue.push( Event{});
+    thread.join();
+}
+
+template <ISA I>
+void Checker<I>::work()
+{
+    while ( true) {
+        auto event = queue.pop();
+        if ( event.type == Event::Type::STOP)
+            return;
+
+        // The rest of events are skipped, the error is rethrown on the simulation thread
+        if ( !has_error.load( std::memory_order_relaxed)) {
+            try {
+                process( event);
+            }
+            catch ( ...) {
+                error = std::current_exception();
+                has_error.store( true, std::memory_order_release);
+            }
+        }
+        processed_events.fetch_add( 1, std::memory_order_release);
+    }
+}
+
+template <ISA I>
+void Checker<I>::post( Event&& event)
+{
+    if ( !active)
+        return;
+
+    if ( !thread.joinable()) {
+        process( event);
+        return;
+    }
+
+    rethrow_error();
+    ++posted_events;
+    queue.push( std::move( event));
+}
+
+template <ISA I>
+void Checker<I>::process( const Event& event)
+{
+    // Only the instructions are replayed, so the state changed by other events has to be saved again
+    if ( event.type != Event::Type::CHECK_INTERVAL)
+        replay_start = std::nullopt;
+
+    switch ( event.type) {
+    case Event::Type::CHECK:          compare( *event.instr, event.cycle); break;
+    case Event::Type::CHECK_INTERVAL: compare_interval( event.interval); break;
+    case Event::Type::DRIVER_STEP:    sim->driver_step( *event.instr); break;
+    case Event::Type::SET_TARGET:     sim->set_target( event.target); break;
+    case Event::Type::STOP:           break;
+    }
+}
+
+template <ISA I>
+void Checker<I>::sync()
+{
+    post_interval();
+    if ( thread.joinable()) {
+        while ( processed_events.load( std::memory_order_acquire) != posted_events && !has_error.load( std::memory_order_acquire))
+            std::this_thread::yield();
+
+        rethrow_error();
+    }
+
+    // Kernel is going to change registers and memory of the checker, the thread is idle until the next event
+    replay_start = std::nullopt;
+}
+
+template <ISA I>
+void Checker<I>::rethrow_error()
+{
+    if ( has_error.load( std::memory_order_acquire))
+        std::rethrow_exception( error);
 }
 
 template <ISA I>
 void Checker<I>::set_target( const Target& value)
 {
-    if ( active)
-        sim->set_target( value);
+    post_interval();
+    post( Event{ Event::Type::SET_TARGET, std::nullopt, value, 0_cl, Interval()});
 }
 
 template <ISA I>
 void Checker<I>::driver_step( const FuncInstr& instr)
 {
-    if ( active)
-        sim->driver_step( instr);
+    // Drivers of the checker have nothing to do with these instructions
+    if ( instr.trap_type() == Trap::NO_TRAP || instr.trap_type() == Trap::HALT)
+        return;
+
+    post_interval();
+    post( Event{ Event::Type::DRIVER_STEP, instr, Target(), 0_cl, Interval()});
+}
+
+template <ISA I>
+void Checker<I>::check( const FuncInstr& instr, Cycle cycle)
+{
+    if ( hash_interval == 0) {
+        post( Event{ Event::Type::CHECK, instr, Target(), cycle, Interval()});
+        return;
+    }
+
+    if ( !active)
+        return;
+
+    perf_hash = hash_instruction( perf_hash, instr);
+    perf_interval.hashes.push_back( perf_hash);
+    perf_interval.cycles.push_back( cycle);
+    if ( perf_interval.hashes.size() >= hash_interval)
+        post_interval();
 }
 
 template <ISA I>
-void Checker<I>::check( const FuncInstr& instr)
+void Checker<I>::post_interval()
 {
-    if (!active)
+    if ( perf_interval.hashes.empty())
         return;
 
+    Event event;
+    event.type = Event::Type::CHECK_INTERVAL;
+    event.interval = std::exchange( perf_interval, {});
+    post( std::move( event));
+}
+
+template <ISA I>
+void Checker<I>::compare( const FuncInstr& instr, Cycle cycle)
+{
     const auto func_dump = sim->step();
 
     if ( func_dump.is_same_checker(instr))
@@ -47,11 +263,54 @@ void Checker<I>::check( const FuncInstr& instr)
     
     std::ostringstream oss;
     oss << "Checker output: " << func_dump << std::endl
-        << "PerfSim output: " << instr     << std::endl;
+        << "PerfSim output: " << instr     << std::endl
+        << "Writeback cycle: " << cycle    << std::endl;
 
     throw CheckerMismatch(oss.str());
 }
 
+template <ISA I>
+void Checker<I>::compare_interval( const Interval& interval)
+{
+    if ( !replay_start.has_value() || replay_start->interval.hashes.size() >= CHECKER_REPLAY_PERIOD)
+        replay_start = ReplayStart{ sim->get_state(), memory->snapshot(), checker_hash, Interval()};
+
+    auto& replayed = replay_start->interval;
+    replayed.hashes.insert( replayed.hashes.end(), interval.hashes.begin(), interval.hashes.end());
+    replayed.cycles.insert( replayed.cycles.end(), interval.cycles.begin(), interval.cycles.end());
+
+    for ( size_t i = 0; i < interval.hashes.size(); ++i)
+        checker_hash = hash_instruction( checker_hash, sim->step());
+
+    if ( checker_hash != interval.hashes.back())
+        report_interval_mismatch( *replay_start);
+}
+
+template <ISA I>
+void Checker<I>::report_interval_mismatch( const ReplayStart& start) const
+{
+    // Hashes diverge after the first different instruction, so it is found by a single replay
+    FuncSim<I> replay( endian, false, isa);
+    replay.set_memory( start.memory);
+    replay.set_state( start.state);
+
+    auto hash = start.hash;
+    for ( size_t i = 0; i < start.interval.hashes.size(); ++i) {
+        const auto func_dump = replay.step();
+        hash = hash_instruction( hash, func_dump);
+        if ( hash == start.interval.hashes[i])
+            continue;
+
+        std::ostringstream oss;
+        oss << "Checker output: " << func_dump << std::endl
+            << "PerfSim output: different state hash, run with --checker-hash-interval 0 to see the instruction" << std::endl
+            << "Writeback cycle: " << start.interval.cycles[i] << std::endl;
+        throw CheckerMismatch(oss.str());
+    }
+
+    throw CheckerMismatch( "State hashes differ, but replay of the checker does not reproduce the difference\n");
+}
+
 #include <mips/mips.h>
 #include <risc_v/risc_v.h>
 
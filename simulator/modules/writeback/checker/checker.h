@@ -3,11 +3,20 @@
  * to check state of performance simulator
  * Copyright 2015-2019 MIPT-MIPS
  */
- 
+
 #ifndef CHECKER_H
 #define CHECKER_H
- 
+
 #include <func_sim/func_sim.h>
+#include <infra/ports/timing.h>
+#include <infra/threads/spsc_queue.h>
+
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
 struct CheckerMismatch final : Exception
 {
@@ -19,18 +28,97 @@ struct CheckerMismatch final : Exception
     { }
 };
 
+/*
+ * By default, the functional simulator is stepped on a separate thread
+ * which receives committed instructions through a queue,
+ * so a mismatch is reported a few cycles after the cycle written in the message.
+ * The performance simulator waits for the checker before system calls,
+ * as the kernel changes the state of both simulators.
+ *
+ * With a non-zero hash interval, both sides keep a rolling hash of committed
+ * PCs, instruction bytes, destination values and store data, and only the hashes
+ * are compared once per interval. The checker saves its state once per a few intervals,
+ * as the memory snapshot makes the next stores copy page tables. On a mismatch,
+ * it replays the instructions from the saved state comparing each one to find the first different one.
+ */
 template<ISA I>
 class Checker {
     using FuncInstr = typename I::FuncInstr;
 public:
-    void disable() { active = false; }
-    void check( const FuncInstr& instr);
+    Checker();
+
+    // Keep dtors in the same translation unit
+    ~Checker();
+    Checker( const Checker&) = delete;
+    Checker( Checker&&) = delete;
+    Checker& operator=( const Checker&) = delete;
+    Checker& operator=( Checker&&) = delete;
+
+    void disable();
+    void reset();
+    void check( const FuncInstr& instr, Cycle cycle);
     void init( std::endian endian, Kernel* kernel, std::string_view isa);
     void set_target( const Target& value);
     void driver_step( const FuncInstr& instr);
+    // Waits until all instructions are checked, throws if a mismatch has been found
+    void sync();
 private:
+    // Rolling hashes and writeback cycles after each instruction of the interval
+    struct Interval
+    {
+        std::vector<uint64> hashes;
+        std::vector<Cycle> cycles;
+    };
+
+    // Instructions checked since the saved state, which is cleared when the state is changed by other means
+    struct ReplayStart
+    {
+        typename FuncSim<I>::State state;
+        std::shared_ptr<FuncMemory> memory;
+        uint64 hash = 0;
+        Interval interval;
+    };
+
+    struct Event
+    {
+        enum class Type : uint8 { CHECK, CHECK_INTERVAL, DRIVER_STEP, SET_TARGET, STOP };
+        Type type = Type::STOP;
+        std::optional<FuncInstr> instr;
+        Target target;
+        Cycle cycle = 0_cl;
+        Interval interval;
+    };
+
+    void post( Event&& event);
+    void post_interval();
+    void process( const Event& event);
+    void work();
+    void start();
+    void stop();
+    void rethrow_error();
+    void compare( const FuncInstr& instr, Cycle cycle);
+    void compare_interval( const Interval& interval);
+    [[noreturn]] void report_interval_mismatch( const ReplayStart& start) const;
+
     std::shared_ptr<FuncSim<I>> sim;
+    std::shared_ptr<FuncMemory> memory;
     bool active = false;
+    std::endian endian = std::endian::native;
+    std::string isa;
+
+    const uint64 hash_interval;
+    Interval perf_interval; // not posted yet
+    uint64 perf_hash = 0;
+    uint64 checker_hash = 0;
+    std::optional<ReplayStart> replay_start;
+
+    const bool is_async;
+    SPSCQueue<Event> queue;
+    std::thread thread;
+    uint64 posted_events = 0;
+    std::atomic<uint64> processed_events = 0;
+    std::atomic<bool> has_error = false;
+    std::exception_ptr error;
 };
 
 #endif // CHECKER_H
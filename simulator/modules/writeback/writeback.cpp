@@ -18,6 +18,17 @@ void Writeback<I>::set_kernel( const std::shared_ptr<Kernel>& k, std::string_vie
     checker.init( endian, kernel.get(), isa);
 }
 
+template <ISA I>
+void Writeback<I>::reset()
+{
+    instrs_to_run = 0;
+    executed_instrs = 0;
+    last_writeback_cycle = 0_cl;
+    next_target = Target( 0, 0);
+    checker.reset();
+    kernel = nullptr;
+}
+
 template<ISA I>
 void Writeback<I>::set_target( const Target& value, Cycle cycle)
 {
@@ -28,7 +39,7 @@ void Writeback<I>::set_target( const Target& value, Cycle cycle)
 template<ISA I>
 void Writeback<I>::set_writeback_target( const Target& value, Cycle cycle)
 {
-    next_PC = value.address;
+    next_target = value;
     wp_trap->write( true, cycle);
     wp_target->write( value, cycle);
 }
@@ -74,6 +85,9 @@ void Writeback<I>::writeback_instruction_system( Writeback<I>::Instr* instr, Cyc
 {
     writeback_instruction( *instr, cycle);
     bool has_syscall = instr->trap_type() == Trap::SYSCALL;
+    // Kernel changes the state of the checker as well
+    if ( has_syscall)
+        checker.sync();
     kernel->handle_instruction( instr);
     auto result_trap = driver->handle_trap( *instr);
     checker.driver_step( *instr);
@@ -92,7 +106,7 @@ template <ISA I>
 void Writeback<I>::writeback_bubble( Cycle cycle)
 {
     sout << "bubble\n";
-    if ( cycle >= last_writeback_cycle + 100_lt)
+    if ( cycle >= get_deadlock_cycle())
         throw Deadlock( "");
 }
 
@@ -104,10 +118,10 @@ void Writeback<I>::writeback_instruction( const Writeback<I>::Instr& instr, Cycl
 
     sout << instr << std::endl;
 
-    checker.check( instr);
+    checker.check( instr, cycle);
     ++executed_instrs;
     last_writeback_cycle = cycle;
-    next_PC = instr.get_actual_target().address;
+    next_target = instr.get_actual_target();
 }
 
 template <ISA I>
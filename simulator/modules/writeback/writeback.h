@@ -13,6 +13,7 @@
 #include <infra/exception.h>
 #include <modules/core/perf_instr.h>
 #include <modules/ports_instance.h>
+#include <modules/ports_topology.h>
 
 struct Deadlock final : Exception
 {
@@ -28,15 +29,18 @@ class Writeback final : public Module
 {
     using FuncInstr = typename I::FuncInstr;
     using Instr = PerfInstr<FuncInstr>;
+    using Ports = PipelinePorts<FuncInstr>;
     using RegisterUInt = typename I::RegisterUInt;
     using InstructionOutput = std::array< RegisterUInt, MAX_DST_NUM>;
 
 private:
+    static constexpr Latency DEADLOCK_LATENCY = 100_lt;
+
     /* Instrumentation */
     uint64 instrs_to_run = 0;
     uint64 executed_instrs = 0;
     Cycle last_writeback_cycle = 0_cl;
-    Addr next_PC = 0;
+    Target next_target = Target( 0, 0);
     const std::endian endian;
     Checker<I> checker;
     std::shared_ptr<Kernel> kernel;
@@ -53,16 +57,16 @@ private:
     void set_checker_target( const Target& value);
 
     /* Input */
-    ReadPort<Instr>* rp_mem_datapath = make_read_port<Instr>("MEMORY_2_WRITEBACK", Port::LATENCY);
-    ReadPort<Instr>* rp_execute_datapath = make_read_port<Instr>("EXECUTE_2_WRITEBACK", Port::LATENCY);
-    ReadPort<Instr>* rp_branch_datapath = make_read_port<Instr>("BRANCH_2_WRITEBACK", Port::LATENCY);    
-    ReadPort<bool>* rp_trap = make_read_port<bool>("WRITEBACK_2_ALL_FLUSH", Port::LATENCY);
+    ReadPort<Instr>* rp_mem_datapath = make_read_port( Ports::MEMORY_2_WRITEBACK, Port::LATENCY);
+    ReadPort<Instr>* rp_execute_datapath = make_read_port( Ports::EXECUTE_2_WRITEBACK, Port::LATENCY);
+    ReadPort<Instr>* rp_branch_datapath = make_read_port( Ports::BRANCH_2_WRITEBACK, Port::LATENCY);    
+    ReadPort<bool>* rp_trap = make_read_port( Ports::WRITEBACK_2_ALL_FLUSH, Port::LATENCY);
 
     /* Output */
-    WritePort<InstructionOutput>* wp_bypass = make_write_port<InstructionOutput>("WRITEBACK_2_EXECUTE_BYPASS", Port::BW);
-    WritePort<Trap>* wp_halt = make_write_port<Trap>("WRITEBACK_2_CORE_HALT", Port::BW);
-    WritePort<bool>* wp_trap = make_write_port<bool>("WRITEBACK_2_ALL_FLUSH", Port::BW);
-    WritePort<Target>* wp_target = make_write_port<Target>("WRITEBACK_2_FETCH_TARGET", Port::BW);
+    WritePort<InstructionOutput>* wp_bypass = make_write_port( Ports::WRITEBACK_2_EXECUTE_BYPASS, Port::BW);
+    WritePort<Trap>* wp_halt = make_write_port( Ports::WRITEBACK_2_CORE_HALT, Port::BW);
+    WritePort<bool>* wp_trap = make_write_port( Ports::WRITEBACK_2_ALL_FLUSH, Port::BW);
+    WritePort<Target>* wp_target = make_write_port( Ports::WRITEBACK_2_FETCH_TARGET, Port::BW);
 
 public:
     Writeback( Module* parent, std::endian endian);
@@ -77,13 +81,20 @@ public:
     void clock( Cycle cycle);
     void set_RF( RF<FuncInstr>* value) { rf = value; }
     void disable_checker() { checker.disable(); }
+    // Throws if the checker has found a mismatch
+    void sync_checker() { checker.sync(); }
     void set_target( const Target& value, Cycle cycle);
     void set_instrs_to_run( uint64 value) { instrs_to_run = value; }
     auto get_executed_instrs() const { return executed_instrs; }
-    Addr get_next_PC() const { return next_PC; }
+    // Writeback throws Deadlock if nothing is written back until this cycle
+    Cycle get_deadlock_cycle() const { return last_writeback_cycle + DEADLOCK_LATENCY; }
+    Addr get_next_PC() const { return next_target.address; }
+    const Target& get_next_target() const { return next_target; }
     int get_exit_code() const noexcept;
     void set_kernel( const std::shared_ptr<Kernel>& k, std::string_view isa);
     void set_driver( std::unique_ptr<Driver> d) { driver = std::move( d); }
+    // Kernel is detached, so the checker copies a state loaded after reset
+    void reset();
     void enable_driver_hooks();
 };
 
@@ -9,7 +9,9 @@
 #include <func_sim/alu/alu.h>
 #include <func_sim/operation.h>
 
+#include <array>
 #include <iomanip>
+#include <map>
 #include <sstream>
 #include <vector>
 
@@ -83,9 +85,9 @@ struct RISCVTableEntry
     size_t num_dst() const { return dst.size(); }
     size_t num_src() const { return src.size(); }
 
-    bool check_mask_and_type( uint32 bytes) const noexcept
+    bool check_type() const noexcept
     {
-        return entry.check_mask( bytes) && (bitwidth<typename I::RegisterUInt> & bit_width) != 0;
+        return (bitwidth<typename I::RegisterUInt> & bit_width) != 0;
     }
 };
 
@@ -271,14 +273,87 @@ static const std::vector<RISCVTableEntry<I>> cmd_desc =
 };
 
 
+/*
+ * Decode index over cmd_desc, built once per instantiation.
+ * The first level is selected by opcode and funct3 (bits 0-6 and 12-15, which
+ * also cover the quadrant and funct3 of compressed instructions), the second one by funct7.
+ * Each cell refers to a short list of candidates in cmd_desc order,
+ * so the first matching candidate is the same entry which linear search would find.
+ */
 template<Executable I>
-const auto& find_entry( uint32 bytes)
+class RISCVDecodeIndex
 {
-    for ( const auto& e : cmd_desc<I>)
-        if ( e.check_mask_and_type( bytes))
-            return e;
+public:
+    RISCVDecodeIndex()
+    {
+        std::map<Group, uint16> group_ids;
+        std::map<Row, uint16> row_ids;
+        for ( uint32 opcode = 0; opcode < OPCODE_KEYS; ++opcode) {
+            Row row = {};
+            for ( uint32 funct7 = 0; funct7 < FUNCT7_KEYS; ++funct7)
+                row.at( funct7) = get_id( &group_ids, &groups, collect_candidates( opcode, funct7));
+
+            opcode_table.at( opcode) = get_id( &row_ids, &rows, row);
+        }
+    }
 
-    return invalid_instr<I>;
+    const RISCVTableEntry<I>& find( uint32 bytes) const noexcept
+    {
+        const auto& row = rows[ opcode_table[ opcode_key( bytes)]];
+        for ( auto id : groups[ row[ funct7_key( bytes)]]) {
+            const auto& e = cmd_desc<I>[id];
+            if ( e.entry.check_mask( bytes))
+                return e;
+        }
+        return invalid_instr<I>;
+    }
+
+private:
+    static constexpr uint32 OPCODE_KEYS = 1U << 11U;
+    static constexpr uint32 FUNCT7_KEYS = 1U << 7U;
+    static constexpr uint32 KEY_MASK = 0xfe00'f07fU;
+
+    using Group = std::vector<uint16>;
+    using Row = std::array<uint16, FUNCT7_KEYS>;
+
+    static uint32 opcode_key( uint32 bytes) noexcept { return ( bytes & 0x7fU) | ( ( bytes >> 5U) & 0x780U); }
+    static uint32 funct7_key( uint32 bytes) noexcept { return bytes >> 25U; }
+    static uint32 key_bits( uint32 opcode, uint32 funct7) noexcept
+    {
+        return ( opcode & 0x7fU) | ( ( opcode & 0x780U) << 5U) | ( funct7 << 25U);
+    }
+
+    static Group collect_candidates( uint32 opcode, uint32 funct7)
+    {
+        const uint32 bits = key_bits( opcode, funct7);
+        Group result;
+        for ( size_t i = 0; i < cmd_desc<I>.size(); ++i) {
+            const auto& e = cmd_desc<I>[i];
+            if ( ( ( bits ^ e.entry.match) & e.entry.mask & KEY_MASK) == 0 && e.check_type())
+                result.push_back( narrow_cast<uint16>( i));
+        }
+        return result;
+    }
+
+    template<typename T>
+    static uint16 get_id( std::map<T, uint16>* ids, std::vector<T>* storage, const T& value)
+    {
+        auto [it, inserted] = ids->emplace( value, narrow_cast<uint16>( storage->size()));
+        if ( inserted)
+            storage->push_back( value);
+        return it->second;
+    }
+
+    std::array<uint16, OPCODE_KEYS> opcode_table = {};
+    std::vector<Row> rows;
+    std::vector<Group> groups;
+};
+
+template<Executable I>
+const auto& find_entry( uint32 bytes)
+{
+    static const RISCVDecodeIndex<I> index;
+    return index.find( bytes);
 }
 
 template<Executable I>
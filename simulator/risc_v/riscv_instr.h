@@ -35,6 +35,7 @@ class RISCVInstr : public BaseInstruction<T, RISCVRegister>
         explicit RISCVInstr( uint32 bytes) : RISCVInstr( bytes, 0) { }
         RISCVInstr( std::string_view name, uint32 immediate) : RISCVInstr( name, immediate, 0)  { }
 
+        uint32 get_bytes() const { return instr; }
         bool is_same_bytes( uint32 bytes) const {
             return bytes == instr;
         }
@@ -35,3 +35,13 @@ TEST_CASE("RISCV32 driver - breakpoint")
     auto expected_cause = Trap( Trap::BREAKPOINT).to_riscv_format();
     CHECK( sim->read_csr_register( "scause") == expected_cause);
 }
+
+TEST_CASE("RISCV32 driver - no trap keeps cause")
+{
+    auto sim = Simulator::create_simulator( "riscv32", true);
+    auto drv = create_riscv32_driver( sim.get());
+    sim->write_csr_register( "stvec", 0x8000);
+    drv->handle_trap( get_op_with_trap( Trap( Trap::BREAKPOINT)));
+    CHECK( drv->handle_trap( get_op_with_trap( Trap( Trap::NO_TRAP))) == Trap::NO_TRAP);
+    CHECK( sim->read_csr_register( "scause") == Trap( Trap::BREAKPOINT).to_riscv_format());
+}
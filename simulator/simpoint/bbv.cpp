@@ -0,0 +1,73 @@
+/*
+ * bbv.cpp - basic block vector profiling
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include "bbv.h"
+
+#include <algorithm>
+#include <fstream>
+
+BBVProfiler::BBVProfiler( uint64 interval_size) : interval_size( interval_size)
+{
+    if ( interval_size == 0)
+        throw BBVError( "interval size must be positive");
+}
+
+void BBVProfiler::end_block()
+{
+    const auto [it, is_new] = block_ids.try_emplace( block_pc, narrow_cast<uint32>( block_ids.size() + 1));
+    if ( is_new)
+        counts.push_back( 0);
+
+    auto& count = counts[it->second - 1];
+    if ( count == 0)
+        touched_ids.push_back( it->second);
+    count += block_size;
+    block_size = 0;
+
+    if ( interval_instrs == interval_size)
+        end_interval();
+}
+
+void BBVProfiler::end_interval()
+{
+    std::sort( touched_ids.begin(), touched_ids.end());
+    BasicBlockVector vector;
+    vector.reserve( touched_ids.size());
+    for ( auto id : touched_ids) {
+        vector.emplace_back( id, counts[id - 1]);
+        counts[id - 1] = 0;
+    }
+    intervals.emplace_back( std::move( vector));
+    touched_ids.clear();
+    interval_instrs = 0;
+}
+
+void BBVProfiler::finish()
+{
+    if ( block_size != 0)
+        end_block();
+    if ( interval_instrs != 0)
+        end_interval();
+}
+
+void BBVProfiler::save( std::ostream& out) const
+{
+    for ( const auto& vector : intervals) {
+        out << 'T';
+        for ( const auto& [id, count] : vector)
+            out << ':' << id << ':' << count << ' ';
+        out << '\n';
+    }
+}
+
+void BBVProfiler::save( const std::string& filename) const
+{
+    std::ofstream out( filename);
+    if ( !out.is_open())
+        throw BBVError( "cannot open " + filename);
+    save( out);
+    if ( !out)
+        throw BBVError( "cannot write " + filename);
+}
@@ -0,0 +1,78 @@
+/*
+ * bbv.h - basic block vector profiling
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef BBV_H
+#define BBV_H
+
+#include <infra/exception.h>
+#include <infra/types.h>
+
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct BBVError final : Exception
+{
+    explicit BBVError( const std::string& msg)
+        : Exception("Basic block profiling error", msg)
+    { }
+};
+
+// Sparse vector of (basic block ID, number of executed instructions), sorted by ID
+using BasicBlockVector = std::vector<std::pair<uint32, uint64>>;
+
+/*
+ * Counts instructions executed in each basic block per fixed-size interval.
+ * Blocks are keyed by their start PC and numbered from 1 in order of appearance,
+ * as SimPoint expects.
+ */
+class BBVProfiler
+{
+public:
+    explicit BBVProfiler( uint64 interval_size);
+
+    // Called for each executed instruction, so keep it cheap
+    void add_instruction( Addr pc, bool ends_block)
+    {
+        // Blocks split by interval boundaries keep their start PC
+        if ( is_block_start)
+            block_pc = pc;
+        is_block_start = ends_block;
+        ++block_size;
+        ++interval_instrs;
+        if ( ends_block || interval_instrs == interval_size)
+            end_block();
+    }
+
+    // Flushes the incomplete block and interval
+    void finish();
+
+    auto get_interval_size() const { return interval_size; }
+    const std::vector<BasicBlockVector>& get_intervals() const { return intervals; }
+    size_t get_blocks_count() const { return block_ids.size(); }
+
+    // Writes vectors in SimPoint .bb format, e.g. "T:1:30 :2:45"
+    void save( std::ostream& out) const;
+    void save( const std::string& filename) const;
+
+private:
+    void end_block();
+    void end_interval();
+
+    const uint64 interval_size;
+    Addr block_pc = 0;
+    bool is_block_start = true;
+    uint64 block_size = 0;
+    uint64 interval_instrs = 0;
+
+    std::unordered_map<Addr, uint32> block_ids;
+    std::vector<uint64> counts; // indexed by block ID - 1
+    std::vector<uint32> touched_ids;
+    std::vector<BasicBlockVector> intervals;
+};
+
+#endif // BBV_H
@@ -0,0 +1,171 @@
+/*
+ * interval_sim.cpp - parallel performance simulation of program intervals
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include "interval_sim.h"
+
+#include <infra/threads/work_stealing_pool.h>
+#include <kernel/kernel.h>
+#include <memory/memory.h>
+#include <simulator.h>
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <memory>
+
+// Passes a task of each simulation point to the handler, returns the number of points reached by the program
+template<typename Handler>
+static size_t capture_simpoints( Simulator* sim, const ReadableMemory& mem, const Kernel& kernel,
+                                 const std::vector<SimPoint>& points, uint64 interval_size, uint64 warm_up, Handler handler)
+{
+    size_t captured = 0;
+    const auto base = sim->get_executed_instrs();
+    for ( const auto& point : points) {
+        const uint64 start = point.interval * interval_size;
+        const uint64 warm_up_start = start - std::min( start, warm_up);
+        const auto position = sim->get_executed_instrs() - base;
+        if ( warm_up_start > position && sim->run_exactly( warm_up_start - position) != Trap::BREAKPOINT)
+            break;
+
+        // Checkpoint cannot be taken in a delay slot
+        while ( !sim->get_target().valid)
+            if ( sim->run_exactly( 1) != Trap::BREAKPOINT)
+                return captured;
+
+        const auto executed = sim->get_executed_instrs() - base;
+        IntervalTask task{ Checkpoint::capture( *sim, mem, kernel), 0, interval_size, point.weight };
+        task.warm_up = start - std::min( start, executed);
+        task.length = interval_size - std::min( interval_size, executed - std::min( executed, start));
+        handler( std::move( task));
+        ++captured;
+    }
+    return captured;
+}
+
+std::vector<IntervalTask> capture_simpoint_tasks( Simulator* sim, const ReadableMemory& mem, const Kernel& kernel,
+                                                  const std::vector<SimPoint>& points, uint64 interval_size, uint64 warm_up)
+{
+    std::vector<IntervalTask> result;
+    capture_simpoints( sim, mem, kernel, points, interval_size, warm_up, [&result]( IntervalTask&& task) {
+        result.emplace_back( std::move( task));
+    });
+    return result;
+}
+
+static IntervalResult simulate_interval( const IntervalTask& task, bool is_mars_kernel)
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+
+    auto sim = CycleAccurateSimulator::create_simulator( task.checkpoint.get_isa());
+    sim->set_statistics_dump( false);
+    auto memory = FuncMemory::create_default_hierarchied_memory();
+    sim->set_memory( memory);
+
+    auto kernel = Kernel::create_kernel( is_mars_kernel, nullin, nullout, nullout);
+    kernel->set_simulator( sim);
+    kernel->connect_memory( memory);
+    kernel->connect_exception_handler();
+    task.checkpoint.restore( sim.get(), memory.get(), kernel.get());
+    sim->set_kernel( kernel);
+    // Intervals are validated by the functional simulation which created the checkpoints
+    sim->disable_checker();
+    sim->set_target( task.checkpoint.get_target());
+
+    IntervalResult result;
+    result.weight = task.weight;
+    result.trap = Trap( Trap::BREAKPOINT);
+    if ( task.warm_up != 0)
+        result.trap = sim->run_exactly( task.warm_up);
+
+    if ( result.trap == Trap::BREAKPOINT && task.length != 0) {
+        const auto before = sim->get_statistics();
+        result.trap = sim->run_exactly( task.length);
+        result.statistics = sim->get_statistics() - before;
+    }
+    return result;
+}
+
+static size_t get_threads_count( const IntervalSimParameters& params)
+{
+    return params.threads != 0 ? params.threads : std::max( 1U, std::thread::hardware_concurrency());
+}
+
+std::vector<IntervalResult> simulate_intervals( const std::vector<IntervalTask>& tasks, const IntervalSimParameters& params)
+{
+    std::vector<IntervalResult> results( tasks.size());
+    WorkStealingPool pool( std::min( get_threads_count( params), std::max<size_t>( tasks.size(), 1)));
+    for ( size_t i = 0; i < tasks.size(); ++i)
+        pool.submit( [&results, &tasks, &params, i]() { results[i] = simulate_interval( tasks[i], params.is_mars_kernel); });
+    pool.wait();
+    return results;
+}
+
+SimPointResults simulate_simpoints( Simulator* sim, const ReadableMemory& mem, const Kernel& kernel,
+                                    const std::vector<SimPoint>& points, uint64 interval_size, uint64 warm_up,
+                                    const IntervalSimParameters& params)
+{
+    // Elements of deque are not moved by insertions, so threads may write results while new tasks are captured
+    std::deque<IntervalResult> results;
+    WorkStealingPool pool( std::min( get_threads_count( params), std::max<size_t>( points.size(), 1)));
+    const auto captured = capture_simpoints( sim, mem, kernel, points, interval_size, warm_up, [&]( IntervalTask&& task) {
+        // Checkpoint is released right after its simulation
+        auto shared_task = std::make_shared<IntervalTask>( std::move( task));
+        pool.submit( [&result = results.emplace_back(), &params, shared_task]() {
+            result = simulate_interval( *shared_task, params.is_mars_kernel);
+        });
+    });
+    pool.wait();
+
+    SimPointResults result;
+    result.intervals.assign( results.begin(), results.end());
+    result.skipped_points = points.size() - captured;
+    for ( size_t i = captured; i < points.size(); ++i)
+        result.skipped_weight += points[i].weight;
+    return result;
+}
+
+WeightedStatistics merge_intervals( const std::vector<IntervalResult>& results)
+{
+    WeightedStatistics result;
+    double jumps_weight = 0;
+    double icache_weight = 0;
+    for ( const auto& interval : results) {
+        const auto& stats = interval.statistics;
+        if ( stats.instrs == 0 || stats.cycles == 0)
+            continue;
+
+        result.total_weight += interval.weight;
+        result.cpi += interval.weight * double( stats.cycles) / double( stats.instrs);
+        if ( stats.jumps != 0) {
+            jumps_weight += interval.weight;
+            result.mispredict_rate += interval.weight * double( stats.mispredictions) / double( stats.jumps);
+        }
+        if ( stats.icache_accesses != 0) {
+            icache_weight += interval.weight;
+            result.icache_miss_rate += interval.weight * double( stats.icache_misses) / double( stats.icache_accesses);
+        }
+    }
+
+    if ( result.total_weight != 0) {
+        result.cpi /= result.total_weight;
+        result.ipc = 1 / result.cpi;
+    }
+    if ( jumps_weight != 0)
+        result.mispredict_rate /= jumps_weight;
+    if ( icache_weight != 0)
+        result.icache_miss_rate /= icache_weight;
+    return result;
+}
+
+std::ostream& operator<<( std::ostream& out, const WeightedStatistics& rhs)
+{
+    return out << std::endl << "****************************"
+               << std::endl << "weighted CPI:         " << rhs.cpi
+               << std::endl << "weighted IPC:         " << rhs.ipc
+               << std::endl << "weighted mispredict:  " << rhs.mispredict_rate * 100 << '%'
+               << std::endl << "weighted icache miss: " << rhs.icache_miss_rate * 100 << '%'
+               << std::endl << "****************************" << std::endl;
+}
@@ -0,0 +1,80 @@
+/*
+ * interval_sim.h - parallel performance simulation of program intervals
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef INTERVAL_SIM_H
+#define INTERVAL_SIM_H
+
+#include "simpoint.h"
+
+#include <checkpoint/checkpoint.h>
+#include <func_sim/traps/trap.h>
+#include <modules/core/sampling.h>
+
+#include <iosfwd>
+#include <vector>
+
+class Kernel;
+class ReadableMemory;
+class Simulator;
+
+// Interval starting from a checkpoint: 'warm_up' instructions to fill caches and predictors, then 'length' measured ones
+struct IntervalTask
+{
+    Checkpoint checkpoint;
+    uint64 warm_up = 0;
+    uint64 length = 0;
+    double weight = 1;
+};
+
+struct IntervalResult
+{
+    PerfStatistics statistics;
+    Trap trap = Trap( Trap::NO_TRAP);
+    double weight = 0;
+};
+
+struct IntervalSimParameters
+{
+    size_t threads = 0; // zero means all host threads
+    bool is_mars_kernel = true; // checkpoints store state of a specific kernel
+};
+
+// Whole-program estimation from weighted intervals
+struct WeightedStatistics
+{
+    double cpi = 0;
+    double ipc = 0;
+    double mispredict_rate = 0;
+    double icache_miss_rate = 0;
+    double total_weight = 0;
+
+    friend std::ostream& operator<<( std::ostream& out, const WeightedStatistics& rhs);
+};
+
+// Results of simulation points in their order; points after the last one are not reached by the program
+struct SimPointResults
+{
+    std::vector<IntervalResult> intervals;
+    size_t skipped_points = 0;
+    double skipped_weight = 0;
+};
+
+// Runs functional simulation from the current state and captures checkpoints before simulation points.
+// If the program ends before a point, tasks are returned for the points before it only.
+std::vector<IntervalTask> capture_simpoint_tasks( Simulator* sim, const ReadableMemory& mem, const Kernel& kernel,
+                                                  const std::vector<SimPoint>& points, uint64 interval_size, uint64 warm_up);
+
+// Same as simulation of captured tasks, but each interval is simulated as soon as its checkpoint is captured
+SimPointResults simulate_simpoints( Simulator* sim, const ReadableMemory& mem, const Kernel& kernel,
+                                    const std::vector<SimPoint>& points, uint64 interval_size, uint64 warm_up,
+                                    const IntervalSimParameters& params = {});
+
+// Simulates each interval by its own performance simulator, results are in order of tasks
+std::vector<IntervalResult> simulate_intervals( const std::vector<IntervalTask>& tasks, const IntervalSimParameters& params = {});
+
+// Averages CPI and rates of intervals with weights, empty intervals are ignored
+WeightedStatistics merge_intervals( const std::vector<IntervalResult>& results);
+
+#endif // INTERVAL_SIM_H
@@ -0,0 +1,254 @@
+/*
+ * simpoint.cpp - selection of representative intervals by k-means clustering
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include "simpoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <numbers>
+#include <random>
+
+using Point = std::vector<double>;
+
+struct Clustering
+{
+    std::vector<Point> centers;
+    std::vector<uint32> labels;
+    double distortion = 0;
+};
+
+static double distance2( const Point& a, const Point& b)
+{
+    double result = 0;
+    for ( size_t i = 0; i < a.size(); ++i)
+        result += ( a[i] - b[i]) * ( a[i] - b[i]);
+    return result;
+}
+
+// Normalizes vectors by the number of instructions and projects them to a few random dimensions
+static std::vector<Point> project( const std::vector<BasicBlockVector>& intervals, const SimPointParameters& params, std::mt19937_64* rng)
+{
+    uint32 max_id = 0;
+    for ( const auto& vector : intervals)
+        if ( !vector.empty())
+            max_id = std::max( max_id, vector.back().first);
+
+    std::uniform_real_distribution<double> distribution( -1, 1);
+    std::vector<Point> matrix( max_id, Point( params.dimensions));
+    for ( auto& row : matrix)
+        for ( auto& value : row)
+            value = distribution( *rng);
+
+    std::vector<Point> result;
+    result.reserve( intervals.size());
+    for ( const auto& vector : intervals) {
+        uint64 total = 0;
+        for ( const auto& entry : vector)
+            total += entry.second;
+
+        Point point( params.dimensions);
+        for ( const auto& [id, count] : vector)
+            for ( size_t i = 0; i < point.size(); ++i)
+                point[i] += matrix[id - 1][i] * double( count) / double( total);
+        result.emplace_back( std::move( point));
+    }
+    return result;
+}
+
+static uint32 find_closest( const Point& point, const std::vector<Point>& centers)
+{
+    uint32 result = 0;
+    for ( uint32 i = 1; i < centers.size(); ++i)
+        if ( distance2( point, centers[i]) < distance2( point, centers[result]))
+            result = i;
+    return result;
+}
+
+// k-means++ seeding
+static std::vector<Point> init_centers( const std::vector<Point>& points, uint32 k, std::mt19937_64* rng)
+{
+    std::vector<Point> centers;
+    centers.push_back( points[std::uniform_int_distribution<size_t>( 0, points.size() - 1)( *rng)]);
+
+    std::vector<double> distances( points.size(), std::numeric_limits<double>::infinity());
+    while ( centers.size() < k) {
+        double total = 0;
+        for ( size_t i = 0; i < points.size(); ++i) {
+            distances[i] = std::min( distances[i], distance2( points[i], centers.back()));
+            total += distances[i];
+        }
+        // All points are covered by existing centers
+        if ( total == 0)
+            break;
+
+        auto threshold = std::uniform_real_distribution<double>( 0, total)( *rng);
+        size_t chosen = 0;
+        while ( chosen + 1 < points.size() && threshold >= distances[chosen])
+            threshold -= distances[chosen++];
+        centers.push_back( points[chosen]);
+    }
+    return centers;
+}
+
+static Clustering run_kmeans( const std::vector<Point>& points, uint32 k, const SimPointParameters& params, std::mt19937_64* rng)
+{
+    Clustering result;
+    result.centers = init_centers( points, k, rng);
+    result.labels.assign( points.size(), 0);
+
+    for ( uint32 iteration = 0; iteration < params.max_iterations; ++iteration) {
+        bool changed = false;
+        for ( size_t i = 0; i < points.size(); ++i) {
+            const auto label = find_closest( points[i], result.centers);
+            changed |= label != result.labels[i];
+            result.labels[i] = label;
+        }
+        if ( !changed && iteration != 0)
+            break;
+
+        std::vector<Point> sums( result.centers.size(), Point( params.dimensions));
+        std::vector<uint64> sizes( result.centers.size());
+        for ( size_t i = 0; i < points.size(); ++i) {
+            ++sizes[result.labels[i]];
+            for ( size_t j = 0; j < params.dimensions; ++j)
+                sums[result.labels[i]][j] += points[i][j];
+        }
+        // Empty clusters keep their centers
+        for ( size_t c = 0; c < sums.size(); ++c)
+            if ( sizes[c] != 0)
+                for ( size_t j = 0; j < params.dimensions; ++j)
+                    result.centers[c][j] = sums[c][j] / double( sizes[c]);
+    }
+
+    for ( size_t i = 0; i < points.size(); ++i)
+        result.distortion += distance2( points[i], result.centers[result.labels[i]]);
+    return result;
+}
+
+// Bayesian information criterion of spherical Gaussian mixture (Pelleg and Moore, X-means)
+static double get_bic( const Clustering& clustering, size_t points_count, uint32 dimensions)
+{
+    const auto r = double( points_count);
+    const auto m = double( dimensions);
+    const auto k = double( clustering.centers.size());
+    const double min_variance = 1e-12;
+    const double variance = points_count > clustering.centers.size()
+        ? std::max( min_variance, clustering.distortion / ( m * ( r - k)))
+        : min_variance;
+
+    std::vector<uint64> sizes( clustering.centers.size());
+    for ( auto label : clustering.labels)
+        ++sizes[label];
+
+    double likelihood = -r * m / 2 * std::log( 2 * std::numbers::pi * variance) - m * ( r - k) / 2;
+    for ( auto size : sizes)
+        if ( size != 0)
+            likelihood += double( size) * std::log( double( size) / r);
+
+    const double parameters = ( k - 1) + m * k + 1;
+    return likelihood - parameters / 2 * std::log( r);
+}
+
+static std::vector<SimPoint> get_simpoints( const std::vector<Point>& points, const Clustering& clustering)
+{
+    std::vector<SimPoint> result;
+    for ( uint32 c = 0; c < clustering.centers.size(); ++c) {
+        size_t size = 0;
+        size_t closest = 0;
+        for ( size_t i = 0; i < points.size(); ++i) {
+            if ( clustering.labels[i] != c)
+                continue;
+            if ( size == 0 || distance2( points[i], clustering.centers[c]) < distance2( points[closest], clustering.centers[c]))
+                closest = i;
+            ++size;
+        }
+        if ( size != 0)
+            result.push_back( { closest, narrow_cast<uint32>( result.size()), double( size) / double( points.size())});
+    }
+    std::sort( result.begin(), result.end(), []( const auto& a, const auto& b) { return a.interval < b.interval; });
+    return result;
+}
+
+std::vector<SimPoint> select_simpoints( const std::vector<BasicBlockVector>& intervals, const SimPointParameters& params)
+{
+    if ( intervals.empty())
+        return {};
+    if ( params.max_clusters == 0 || params.dimensions == 0)
+        throw BBVError( "number of clusters and dimensions must be positive");
+
+    std::mt19937_64 rng( params.seed);
+    const auto points = project( intervals, params, &rng);
+    const auto max_k = narrow_cast<uint32>( std::min<size_t>( params.max_clusters, points.size()));
+
+    std::vector<Clustering> clusterings;
+    std::vector<double> scores;
+    for ( uint32 k = 1; k <= max_k; ++k) {
+        clusterings.emplace_back( run_kmeans( points, k, params, &rng));
+        scores.push_back( get_bic( clusterings.back(), points.size(), params.dimensions));
+    }
+
+    const auto [min_score, max_score] = std::minmax_element( scores.begin(), scores.end());
+    const auto threshold = *min_score + params.bic_threshold * ( *max_score - *min_score);
+    const auto chosen = std::find_if( scores.begin(), scores.end(), [threshold]( auto score) { return score >= threshold; });
+    return get_simpoints( points, clusterings[narrow_cast<size_t>( chosen - scores.begin())]);
+}
+
+void save_simpoints( const std::vector<SimPoint>& points, std::ostream& simpoints, std::ostream& weights)
+{
+    for ( const auto& point : points) {
+        simpoints << point.interval << ' ' << point.cluster << '\n';
+        weights << point.weight << ' ' << point.cluster << '\n';
+    }
+}
+
+void save_simpoints( const std::vector<SimPoint>& points, const std::string& prefix)
+{
+    std::ofstream simpoints( prefix + ".simpoints");
+    std::ofstream weights( prefix + ".weights");
+    if ( !simpoints.is_open() || !weights.is_open())
+        throw BBVError( "cannot open " + prefix + ".simpoints or " + prefix + ".weights");
+    save_simpoints( points, simpoints, weights);
+}
+
+std::vector<SimPoint> load_simpoints( std::istream& simpoints, std::istream& weights)
+{
+    std::map<uint32, SimPoint> clusters;
+    SimPoint point;
+    while ( simpoints >> point.interval >> point.cluster)
+        if ( !clusters.emplace( point.cluster, point).second)
+            throw BBVError( "cluster " + std::to_string( point.cluster) + " has two simulation points");
+    if ( !simpoints.eof())
+        throw BBVError( "simulation points are not in \"<interval> <cluster>\" format");
+
+    double weight = 0;
+    uint32 cluster = 0;
+    while ( weights >> weight >> cluster) {
+        const auto it = clusters.find( cluster);
+        if ( it == clusters.end())
+            throw BBVError( "cluster " + std::to_string( cluster) + " has weight but no simulation point");
+        it->second.weight = weight;
+    }
+    if ( !weights.eof())
+        throw BBVError( "weights are not in \"<weight> <cluster>\" format");
+
+    std::vector<SimPoint> result;
+    result.reserve( clusters.size());
+    for ( const auto& entry : clusters)
+        result.push_back( entry.second);
+    std::sort( result.begin(), result.end(), []( const auto& lhs, const auto& rhs) { return lhs.interval < rhs.interval; });
+    return result;
+}
+
+std::vector<SimPoint> load_simpoints( const std::string& prefix)
+{
+    std::ifstream simpoints( prefix + ".simpoints");
+    std::ifstream weights( prefix + ".weights");
+    if ( !simpoints.is_open() || !weights.is_open())
+        throw BBVError( "cannot open " + prefix + ".simpoints or " + prefix + ".weights");
+    return load_simpoints( simpoints, weights);
+}
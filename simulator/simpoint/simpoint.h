@@ -0,0 +1,45 @@
+/*
+ * simpoint.h - selection of representative intervals by k-means clustering
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef SIMPOINT_H
+#define SIMPOINT_H
+
+#include "bbv.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct SimPointParameters
+{
+    uint32 max_clusters = 10;
+    // Vectors are randomly projected to a few dimensions before clustering
+    uint32 dimensions = 15;
+    uint32 max_iterations = 100;
+    uint64 seed = 1;
+    // The smallest number of clusters with BIC score above this fraction of the score range is chosen
+    double bic_threshold = 0.9;
+};
+
+// Interval closest to the center of a cluster, weighted by the share of intervals in the cluster
+struct SimPoint
+{
+    size_t interval = 0;
+    uint32 cluster = 0;
+    double weight = 0;
+};
+
+// Returns simulation points sorted by interval, weights sum up to 1
+std::vector<SimPoint> select_simpoints( const std::vector<BasicBlockVector>& intervals, const SimPointParameters& params = {});
+
+// Writes SimPoint-compatible "<interval> <cluster>" and "<weight> <cluster>" lines
+void save_simpoints( const std::vector<SimPoint>& points, std::ostream& simpoints, std::ostream& weights);
+void save_simpoints( const std::vector<SimPoint>& points, const std::string& prefix);
+
+// Reads files written by save_simpoints, points are sorted by interval
+std::vector<SimPoint> load_simpoints( std::istream& simpoints, std::istream& weights);
+std::vector<SimPoint> load_simpoints( const std::string& prefix);
+
+#endif // SIMPOINT_H
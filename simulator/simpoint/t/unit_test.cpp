@@ -0,0 +1,275 @@
+/*
+ * Unit tests for basic block vectors and simulation points
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include <catch.hpp>
+
+#include <kernel/kernel.h>
+#include <memory/memory.h>
+#include <simpoint/bbv.h>
+#include <simpoint/interval_sim.h>
+#include <simpoint/simpoint.h>
+#include <simulator.h>
+
+#include <iostream>
+#include <sstream>
+
+TEST_CASE( "BBV: count blocks per interval")
+{
+    BBVProfiler profiler( 5);
+    // Block at 0x100 of 3 instructions, executed twice, then a block at 0x200
+    for ( int i = 0; i < 2; ++i) {
+        profiler.add_instruction( 0x100, false);
+        profiler.add_instruction( 0x104, false);
+        profiler.add_instruction( 0x108, true);
+    }
+    profiler.add_instruction( 0x200, true);
+    profiler.finish();
+
+    CHECK( profiler.get_blocks_count() == 2);
+    REQUIRE( profiler.get_intervals().size() == 2);
+    CHECK( profiler.get_intervals()[0] == BasicBlockVector{ { 1, 5}});
+    CHECK( profiler.get_intervals()[1] == BasicBlockVector{ { 1, 1}, { 2, 1}});
+
+    std::ostringstream out;
+    profiler.save( out);
+    CHECK( out.str() == "T:1:5 \nT:1:1 :2:1 \n");
+}
+
+TEST_CASE( "BBV: block split by interval boundary keeps its start")
+{
+    BBVProfiler profiler( 2);
+    profiler.add_instruction( 0x100, false);
+    profiler.add_instruction( 0x104, false);
+    profiler.add_instruction( 0x108, true);
+    profiler.add_instruction( 0x100, true);
+    profiler.finish();
+
+    CHECK( profiler.get_blocks_count() == 1);
+    REQUIRE( profiler.get_intervals().size() == 2);
+    CHECK( profiler.get_intervals()[1] == BasicBlockVector{ { 1, 2}});
+}
+
+TEST_CASE( "BBV: zero interval")
+{
+    CHECK_THROWS_AS( BBVProfiler( 0), BBVError);
+}
+
+static std::vector<BasicBlockVector> get_two_phases()
+{
+    std::vector<BasicBlockVector> result;
+    for ( int i = 0; i < 6; ++i)
+        result.push_back( { { 1, 90}, { 2, 10}});
+    for ( int i = 0; i < 2; ++i)
+        result.push_back( { { 3, 50}, { 4, 50}});
+    result.push_back( { { 1, 900}, { 2, 100}});
+    return result;
+}
+
+TEST_CASE( "SimPoint: two phases")
+{
+    const auto points = select_simpoints( get_two_phases());
+    REQUIRE( points.size() == 2);
+    CHECK( points[0].interval < 6);
+    CHECK( points[0].weight == Approx( 7.0 / 9));
+    CHECK( ( points[1].interval == 6 || points[1].interval == 7));
+    CHECK( points[1].weight == Approx( 2.0 / 9));
+    CHECK( points[0].cluster != points[1].cluster);
+}
+
+TEST_CASE( "SimPoint: single cluster")
+{
+    SimPointParameters params;
+    params.max_clusters = 1;
+    const auto points = select_simpoints( get_two_phases(), params);
+    REQUIRE( points.size() == 1);
+    CHECK( points[0].weight == 1);
+}
+
+TEST_CASE( "SimPoint: no intervals")
+{
+    CHECK( select_simpoints( {}).empty());
+}
+
+TEST_CASE( "SimPoint: save")
+{
+    std::ostringstream simpoints;
+    std::ostringstream weights;
+    save_simpoints( { { 3, 0, 0.75}, { 8, 1, 0.25}}, simpoints, weights);
+    CHECK( simpoints.str() == "3 0\n8 1\n");
+    CHECK( weights.str() == "0.75 0\n0.25 1\n");
+}
+
+TEST_CASE( "SimPoint: load")
+{
+    std::istringstream simpoints( "8 1\n3 0\n");
+    std::istringstream weights( "0.75 0\n0.25 1\n");
+    const auto points = load_simpoints( simpoints, weights);
+    REQUIRE( points.size() == 2);
+    CHECK( points[0].interval == 3);
+    CHECK( points[0].cluster == 0);
+    CHECK( points[0].weight == 0.75);
+    CHECK( points[1].interval == 8);
+    CHECK( points[1].weight == 0.25);
+}
+
+TEST_CASE( "SimPoint: load bad files")
+{
+    const auto load = []( const std::string& simpoints, const std::string& weights) {
+        std::istringstream simpoints_stream( simpoints);
+        std::istringstream weights_stream( weights);
+        return load_simpoints( simpoints_stream, weights_stream);
+    };
+    CHECK_THROWS_AS( load( "3 0\n8 0\n", "1 0\n"), BBVError);
+    CHECK_THROWS_AS( load( "3 zero\n", "1 0\n"), BBVError);
+    CHECK_THROWS_AS( load( "3 0\n", "1 1\n"), BBVError);
+    CHECK_THROWS_AS( load( "3 0\n", "heavy 0\n"), BBVError);
+    CHECK_THROWS_AS( load_simpoints( "/nonexistent/prefix"), BBVError);
+}
+
+struct System
+{
+    std::shared_ptr<Simulator> sim;
+    std::shared_ptr<FuncMemory> mem;
+    std::shared_ptr<Kernel> kernel;
+};
+
+static System create_system( const std::string& isa, bool functional_only, std::istream& in, std::ostream& out)
+{
+    System system{ Simulator::create_simulator( isa, functional_only),
+                   FuncMemory::create_default_hierarchied_memory(),
+                   Kernel::create_kernel( true, in, out, out) };
+    system.sim->set_memory( system.mem);
+    system.kernel->set_simulator( system.sim);
+    system.kernel->connect_memory( system.mem);
+    system.kernel->connect_exception_handler();
+    system.kernel->load_file( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin");
+    system.sim->set_kernel( system.kernel);
+    system.sim->set_pc( system.kernel->get_start_pc());
+    return system;
+}
+
+static auto run_profiled( const std::string& isa, bool functional_only, const std::shared_ptr<BBVProfiler>& profiler)
+{
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto system = create_system( isa, functional_only, nullin, nullout);
+    system.sim->set_bbv_profiler( profiler);
+
+    OStreamWrapper cout_wrapper( std::cout, nullout);
+    return system.sim->run_no_limit();
+}
+
+TEST_CASE( "BBV: profile functional simulation")
+{
+    auto profiler = std::make_shared<BBVProfiler>( 1000);
+    CHECK( run_profiled( "mars", true, profiler) == Trap::HALT);
+    profiler->finish();
+
+    REQUIRE( profiler->get_intervals().size() > 2);
+    CHECK( profiler->get_blocks_count() > 10);
+    for ( size_t i = 0; i + 1 < profiler->get_intervals().size(); ++i) {
+        uint64 total = 0;
+        for ( const auto& entry : profiler->get_intervals()[i])
+            total += entry.second;
+        CHECK( total == 1000);
+    }
+
+    const auto points = select_simpoints( profiler->get_intervals());
+    CHECK_FALSE( points.empty());
+    double weights = 0;
+    for ( const auto& point : points)
+        weights += point.weight;
+    CHECK( weights == Approx( 1));
+}
+
+TEST_CASE( "BBV: performance simulation cannot be profiled")
+{
+    auto profiler = std::make_shared<BBVProfiler>( 1000);
+    CHECK_THROWS_AS( run_profiled( "mars", false, profiler), BBVError);
+}
+
+TEST_CASE( "Interval simulation: merge")
+{
+    std::vector<IntervalResult> results( 3);
+    results[0].statistics = PerfStatistics{ 100, 200, 10, 2, 100, 10};
+    results[0].weight = 0.75;
+    results[1].statistics = PerfStatistics{ 100, 100, 0, 0, 100, 0};
+    results[1].weight = 0.25;
+    results[2].weight = 0.5; // empty interval
+
+    const auto merged = merge_intervals( results);
+    CHECK( merged.total_weight == 1);
+    CHECK( merged.cpi == Approx( 0.75 * 2 + 0.25 * 1));
+    CHECK( merged.ipc == Approx( 1 / merged.cpi));
+    CHECK( merged.mispredict_rate == Approx( 0.2));
+    CHECK( merged.icache_miss_rate == Approx( 0.75 * 0.1));
+}
+
+TEST_CASE( "Interval simulation: simulation points in parallel")
+{
+    const uint64 interval_size = 500;
+    auto profiler = std::make_shared<BBVProfiler>( interval_size);
+    CHECK( run_profiled( "mars", true, profiler) == Trap::HALT);
+    profiler->finish();
+    const auto points = select_simpoints( profiler->get_intervals());
+    REQUIRE( points.size() > 1);
+
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto system = create_system( "mars", true, nullin, nullout);
+    std::vector<IntervalTask> tasks;
+    {
+        OStreamWrapper cout_wrapper( std::cout, nullout);
+        tasks = capture_simpoint_tasks( system.sim.get(), *system.mem, *system.kernel, points, interval_size, 100);
+    }
+    REQUIRE( tasks.size() == points.size());
+
+    IntervalSimParameters params;
+    params.threads = 4;
+    const auto parallel = simulate_intervals( tasks, params);
+    params.threads = 1;
+    const auto sequential = simulate_intervals( tasks, params);
+
+    REQUIRE( parallel.size() == tasks.size());
+    for ( size_t i = 0; i < tasks.size(); ++i) {
+        CHECK( parallel[i].statistics.instrs > 0);
+        CHECK( parallel[i].statistics.cycles == sequential[i].statistics.cycles);
+        CHECK( parallel[i].statistics.instrs == sequential[i].statistics.instrs);
+    }
+
+    const auto merged = merge_intervals( parallel);
+    CHECK( merged.total_weight == Approx( 1));
+    CHECK( merged.ipc > 0);
+    CHECK( merged.ipc <= 1);
+}
+
+TEST_CASE( "Interval simulation: simulation points after the end of program")
+{
+    const uint64 interval_size = 500;
+    auto profiler = std::make_shared<BBVProfiler>( interval_size);
+    CHECK( run_profiled( "mars", true, profiler) == Trap::HALT);
+    profiler->finish();
+    auto points = select_simpoints( profiler->get_intervals());
+    REQUIRE_FALSE( points.empty());
+    const auto reached = points.size();
+    points.push_back( SimPoint{ 1'000'000, 0, 0.25});
+    points.push_back( SimPoint{ 2'000'000, 1, 0.5});
+
+    std::istream nullin( nullptr);
+    std::ostream nullout( nullptr);
+    auto system = create_system( "mars", true, nullin, nullout);
+    IntervalSimParameters params;
+    params.threads = 2;
+    SimPointResults results;
+    {
+        OStreamWrapper cout_wrapper( std::cout, nullout);
+        results = simulate_simpoints( system.sim.get(), *system.mem, *system.kernel, points, interval_size, 100, params);
+    }
+    REQUIRE( results.intervals.size() == reached);
+    CHECK( results.skipped_points == 2);
+    CHECK( results.skipped_weight == Approx( 0.75));
+    for ( const auto& interval : results.intervals)
+        CHECK( interval.statistics.instrs > 0);
+}
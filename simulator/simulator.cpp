@@ -9,6 +9,7 @@
  
 // Simulators
 #include <func_sim/func_sim.h>
+#include <modules/core/hybrid_sim.h>
 #include <modules/core/perf_sim.h>
 
 // ISAs
@@ -17,12 +18,15 @@
 
 #include "simulator.h"
 
+#include <simpoint/bbv.h>
+
 #include <algorithm>
 
 namespace config {
     static const AliasedValue<std::string> isa = { "I", "isa", "mars", "modeled ISA"};
     static const AliasedSwitch disassembly_on = { "d", "disassembly", "print disassembly"};
     static const AliasedSwitch functional_only = { "f", "functional-only", "run functional simulation only"};
+    static const Value<uint64> fast_forward = { "fast-forward", 0, "number of instructions to run functionally before performance simulation"};
 } // namespace config
 
 void CPUModel::duplicate_all_registers_to( CPUModel* model) const
@@ -32,10 +36,26 @@ void CPUModel::duplicate_all_registers_to( CPUModel* model) const
         model->write_cpu_register( i, read_cpu_register( i));
 }
 
+void Simulator::set_bbv_profiler( std::shared_ptr<BBVProfiler> /* profiler */)
+{
+    throw BBVError( "basic block vectors are collected by functional simulator only");
+}
+
+Trap Simulator::run_exactly( uint64 instrs_to_run)
+{
+    const auto start = get_executed_instrs();
+    const auto end = start + std::min( instrs_to_run, MAX_VAL64 - start);
+    auto trap = Trap( Trap::BREAKPOINT);
+    while ( trap == Trap::BREAKPOINT && get_executed_instrs() < end)
+        trap = run( end - get_executed_instrs());
+    return trap;
+}
+
 class SimulatorFactory {
     struct Builder {
-        virtual std::unique_ptr<Simulator> get_funcsim( bool log) = 0;
-        virtual std::unique_ptr<CycleAccurateSimulator> get_perfsim() = 0;
+        virtual std::unique_ptr<Simulator> get_funcsim( bool log) const = 0;
+        virtual std::unique_ptr<CycleAccurateSimulator> get_perfsim() const = 0;
+        virtual std::unique_ptr<Simulator> get_hybrid( uint64 fast_forward, const SamplingParameters& sampling) const = 0;
         Builder() = default;
         virtual ~Builder() = default;
         Builder( const Builder&) = delete;
@@ -49,8 +69,9 @@ class SimulatorFactory {
         const std::string isa;
         const std::endian e;
         TBuilder( std::string_view isa, std::endian e) : isa( isa), e( e) { }
-        std::unique_ptr<Simulator> get_funcsim( bool log) final { return std::make_unique<FuncSim<T>>( e, log, isa); }
-        std::unique_ptr<CycleAccurateSimulator> get_perfsim() final { return std::make_unique<PerfSim<T>>( e, isa); }
+        std::unique_ptr<Simulator> get_funcsim( bool log) const final { return std::make_unique<FuncSim<T>>( e, log, isa); }
+        std::unique_ptr<CycleAccurateSimulator> get_perfsim() const final { return std::make_unique<PerfSim<T>>( e, isa); }
+        std::unique_ptr<Simulator> get_hybrid( uint64 fast_forward, const SamplingParameters& sampling) const final { return std::make_unique<HybridSim<T>>( e, isa, fast_forward, sampling); }
     };
 
     std::map<std::string, std::unique_ptr<Builder>> map;
@@ -105,9 +126,10 @@ class SimulatorFactory {
     }
 
 public:
-    static SimulatorFactory& get_instance()
+    // Immutable after construction, so simulators may be created from several threads
+    static const SimulatorFactory& get_instance()
     {
-        static SimulatorFactory sf;
+        static const SimulatorFactory sf;
         return sf;
     }
 
@@ -127,6 +149,11 @@ public:
     {
         return get_factory( name)->get_perfsim();
     }
+
+    auto get_hybrid( const std::string& name, uint64 fast_forward, const SamplingParameters& sampling) const
+    {
+        return get_factory( name)->get_hybrid( fast_forward, sampling);
+    }
 };
 
 std::vector<std::string>
@@ -135,6 +162,12 @@ Simulator::get_supported_isa()
     return SimulatorFactory::get_instance().get_supported_isa();
 }
 
+std::string
+Simulator::get_configured_isa()
+{
+    return config::isa;
+}
+
 std::shared_ptr<Simulator>
 Simulator::create_simulator( const std::string& isa, bool functional_only, bool log)
 {
@@ -159,9 +192,26 @@ Simulator::create_configured_simulator()
 std::shared_ptr<Simulator>
 Simulator::create_configured_isa_simulator( const std::string& isa)
 {
+    const uint64 fast_forward = config::fast_forward;
+    const auto sampling = SamplingParameters::create_configured();
+    if ( !config::functional_only && ( fast_forward != 0 || sampling.is_enabled()))
+        return create_hybrid_simulator( isa, fast_forward, sampling);
+
     return create_simulator( isa, config::functional_only, config::disassembly_on);
 }
 
+std::shared_ptr<Simulator>
+Simulator::create_hybrid_simulator( const std::string& isa, uint64 fast_forward, const SamplingParameters& sampling)
+{
+    return SimulatorFactory::get_instance().get_hybrid( isa, fast_forward, sampling);
+}
+
+std::shared_ptr<Simulator>
+Simulator::create_hybrid_simulator( const std::string& isa, uint64 fast_forward)
+{
+    return create_hybrid_simulator( isa, fast_forward, SamplingParameters());
+}
+
 std::shared_ptr<CycleAccurateSimulator>
 CycleAccurateSimulator::create_simulator( const std::string& isa)
 {
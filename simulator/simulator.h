@@ -57,9 +57,18 @@ public:
     void duplicate_all_registers_to( CPUModel* model) const;
 };
 
+class BBVProfiler;
 class FuncMemory;
 class Kernel;
+struct PerfStatistics;
+struct SamplingParameters;
+struct SamplingReport;
 
+/*
+ * Simulators do not share mutable state: independent instances,
+ * each with its own memory and kernel, may run on different threads.
+ * Options are read when a simulator is created, see config::ScopedOverrides.
+ */
 class Simulator : public CPUModel
 {
 public:
@@ -70,15 +79,34 @@ public:
     virtual void disable_checker() = 0;
     virtual void enable_driver_hooks() = 0;
     virtual int get_exit_code() const noexcept = 0;
+    // Target of the next instruction to execute, invalid if there is no single one (e.g. in a delay slot)
+    virtual Target get_target() const = 0;
+    virtual uint64 get_executed_instrs() const = 0;
+    // Only functional simulation can be profiled
+    virtual void set_bbv_profiler( std::shared_ptr<BBVProfiler> profiler);
+    // Estimations of sampled simulation, nullptr if simulation is not sampled
+    virtual const SamplingReport* get_sampling_report() const { return nullptr; }
+    // Returns to the state of a new simulator, keeping allocated structures and connected memory:
+    // registers, pipeline, predictors, caches and statistics are cleared, the kernel is detached.
+    // A new program may be loaded to the memory, then the kernel and the target should be set again.
+    virtual void reset() = 0;
     std::string_view get_isa() const final { return isa; }
 
     Trap run_no_limit() { return run( MAX_VAL64); }
+    // Unlike run(), does not stop at break instructions
+    Trap run_exactly( uint64 instrs_to_run);
 
     static std::vector<std::string> get_supported_isa();
+    static std::string get_configured_isa();
     static std::shared_ptr<Simulator> create_simulator( const std::string& isa, bool functional_only, bool log);
     static std::shared_ptr<Simulator> create_simulator( const std::string& isa, bool functional_only);
     static std::shared_ptr<Simulator> create_configured_simulator();
     static std::shared_ptr<Simulator> create_configured_isa_simulator( const std::string& isa);
+    // Functional simulation of first 'fast_forward' instructions, performance simulation afterwards
+    // If sampling is enabled, only periodic windows are simulated in details
+    static std::shared_ptr<Simulator> create_hybrid_simulator( const std::string& isa, uint64 fast_forward,
+                                                               const SamplingParameters& sampling);
+    static std::shared_ptr<Simulator> create_hybrid_simulator( const std::string& isa, uint64 fast_forward);
     static std::shared_ptr<Simulator> create_functional_simulator( const std::string& isa, bool log)
     {
         return create_simulator( isa, true, log);
@@ -97,6 +125,8 @@ class CycleAccurateSimulator : public Simulator, public Root
 public:
     explicit CycleAccurateSimulator( std::string_view isa) : Simulator( isa), Root( "cpu") { }
     virtual void clock() = 0;
+    virtual PerfStatistics get_statistics() const = 0;
+    virtual void set_statistics_dump( bool value) = 0;
     static std::shared_ptr<CycleAccurateSimulator> create_simulator(const std::string& isa);
 };
 
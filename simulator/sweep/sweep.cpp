@@ -0,0 +1,276 @@
+/*
+ * sweep.cpp - parallel simulation of a program over a grid of configurations
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include "sweep.h"
+
+#include <infra/threads/work_stealing_pool.h>
+#include <kernel/kernel.h>
+#include <memory/memory.h>
+#include <simulator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+static std::string_view trim( std::string_view value)
+{
+    const auto begin = value.find_first_not_of( " \t\r\n");
+    if ( begin == std::string_view::npos)
+        return {};
+    const auto end = value.find_last_not_of( " \t\r\n");
+    return value.substr( begin, end - begin + 1);
+}
+
+static std::vector<std::string> split_values( std::string_view values, size_t line)
+{
+    std::vector<std::string> result;
+    while ( true) {
+        const auto comma = values.find( ',');
+        const auto value = trim( values.substr( 0, comma));
+        if ( value.empty())
+            throw SweepError( "empty value at line " + std::to_string( line));
+        result.emplace_back( value);
+        if ( comma == std::string_view::npos)
+            return result;
+        values.remove_prefix( comma + 1);
+    }
+}
+
+static SweepPoint parse_point( std::string_view values, size_t line)
+{
+    SweepPoint result;
+    std::istringstream in{ std::string( values)};
+    std::string pair;
+    while ( in >> pair) {
+        const auto equal = pair.find( '=');
+        if ( equal == 0 || equal == std::string::npos || equal + 1 == pair.size())
+            throw SweepError( "expected name=value instead of '" + pair + "' at line " + std::to_string( line));
+        if ( !result.emplace( pair.substr( 0, equal), pair.substr( equal + 1)).second)
+            throw SweepError( "option " + pair.substr( 0, equal) + " is repeated at line " + std::to_string( line));
+    }
+    if ( result.empty())
+        throw SweepError( "empty point at line " + std::to_string( line));
+    return result;
+}
+
+std::vector<SweepPoint> parse_sweep_grid( std::istream& in)
+{
+    static const std::string_view point_prefix = "point:";
+    std::vector<SweepPoint> points;
+    std::vector<std::pair<std::string, std::vector<std::string>>> axes;
+    std::string buffer;
+    for ( size_t line = 1; std::getline( in, buffer); ++line) {
+        const auto text = trim( std::string_view( buffer).substr( 0, buffer.find( '#')));
+        if ( text.empty())
+            continue;
+
+        if ( text.starts_with( point_prefix)) {
+            points.emplace_back( parse_point( text.substr( point_prefix.size()), line));
+            continue;
+        }
+
+        const auto equal = text.find( '=');
+        const auto name = trim( text.substr( 0, equal));
+        if ( equal == std::string_view::npos || name.empty())
+            throw SweepError( "expected 'name = values' or 'point: name=value' at line " + std::to_string( line));
+        if ( std::any_of( axes.begin(), axes.end(), [name]( const auto& axis) { return axis.first == name; }))
+            throw SweepError( "option " + std::string( name) + " is repeated at line " + std::to_string( line));
+        axes.emplace_back( name, split_values( text.substr( equal + 1), line));
+    }
+
+    if ( points.empty() && axes.empty())
+        throw SweepError( "no configurations");
+    if ( points.empty())
+        points.emplace_back();
+
+    for ( const auto& [name, values] : axes) {
+        std::vector<SweepPoint> product;
+        product.reserve( points.size() * values.size());
+        for ( const auto& point : points) {
+            if ( point.contains( name))
+                throw SweepError( "option " + name + " is both swept and set by a point");
+            for ( const auto& value : values) {
+                product.push_back( point);
+                product.back().emplace( name, value);
+            }
+        }
+        points = std::move( product);
+    }
+    return points;
+}
+
+std::vector<SweepPoint> parse_sweep_grid( const std::string& filename)
+{
+    std::ifstream in( filename);
+    if ( !in.is_open())
+        throw SweepError( "cannot open " + filename);
+    return parse_sweep_grid( in);
+}
+
+static double ratio( uint64 numerator, uint64 denominator)
+{
+    return denominator == 0 ? 0 : double( numerator) / double( denominator);
+}
+
+double SweepResult::get_ipc() const { return ratio( statistics.instrs, statistics.cycles); }
+double SweepResult::get_mispredict_rate() const { return ratio( statistics.mispredictions, statistics.jumps); }
+double SweepResult::get_icache_miss_rate() const { return ratio( statistics.icache_misses, statistics.icache_accesses); }
+double SweepResult::get_kips() const { return seconds == 0 ? 0 : double( statistics.instrs) / seconds / 1000; }
+
+Checkpoint load_sweep_program( const std::string& filename)
+{
+    auto sim = Simulator::create_functional_simulator( Simulator::get_configured_isa());
+    auto memory = FuncMemory::create_default_hierarchied_memory();
+    sim->set_memory( memory);
+    sim->write_csr_register( "mscratch", 0x400'0000);
+
+    auto kernel = Kernel::create_configured_kernel();
+    kernel->set_simulator( sim);
+    kernel->connect_memory( memory);
+    kernel->connect_exception_handler();
+    kernel->load_file( filename);
+    sim->set_pc( kernel->get_start_pc());
+    return Checkpoint::capture( *sim, *memory, *kernel);
+}
+
+static SweepResult simulate_point( const Checkpoint& start, const SweepPoint& inherited, const SweepPoint& point, uint64 instrs)
+{
+    SweepResult result;
+    result.point = point;
+    try {
+        const config::ScopedOverrides caller_overrides( inherited);
+        const config::ScopedOverrides overrides( point);
+        std::istream nullin( nullptr);
+        std::ostream nullout( nullptr);
+
+        auto sim = CycleAccurateSimulator::create_simulator( start.get_isa());
+        sim->set_statistics_dump( false);
+        auto memory = FuncMemory::create_default_hierarchied_memory();
+        sim->set_memory( memory);
+
+        auto kernel = Kernel::create_configured_kernel( nullin, nullout, nullout);
+        kernel->set_simulator( sim);
+        kernel->connect_memory( memory);
+        kernel->connect_exception_handler();
+        start.restore( sim.get(), memory.get(), kernel.get());
+        sim->set_kernel( kernel);
+        // Checker would be included into the measured simulation speed
+        sim->disable_checker();
+        sim->set_target( start.get_target());
+
+        const auto begin = std::chrono::steady_clock::now();
+        result.trap = sim->run_exactly( instrs);
+        result.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - begin).count();
+        result.statistics = sim->get_statistics();
+    }
+    catch ( const std::exception& e) {
+        result.error = trim( e.what());
+    }
+    return result;
+}
+
+std::vector<SweepResult> run_sweep( const Checkpoint& start, const std::vector<SweepPoint>& points, const SweepParameters& params)
+{
+    std::vector<SweepResult> results( points.size());
+    const auto inherited = config::ScopedOverrides::get_active();
+    const size_t threads = params.threads != 0 ? params.threads : std::max( 1U, std::thread::hardware_concurrency());
+    WorkStealingPool pool( std::min( threads, std::max<size_t>( points.size(), 1)));
+    for ( size_t i = 0; i < points.size(); ++i)
+        pool.submit( [&results, &start, &inherited, &points, &params, i]() {
+            results[i] = simulate_point( start, inherited, points[i], params.instrs);
+        });
+    pool.wait();
+    return results;
+}
+
+static std::set<std::string, std::less<>> get_option_names( const std::vector<SweepResult>& results)
+{
+    std::set<std::string, std::less<>> names;
+    for ( const auto& result : results)
+        for ( const auto& option : result.point)
+            names.insert( option.first);
+    return names;
+}
+
+static std::string to_string( const Trap& trap)
+{
+    std::ostringstream out;
+    out << trap;
+    return out.str();
+}
+
+static std::string csv_field( const std::string& value)
+{
+    if ( value.find_first_of( ",\"\r\n") == std::string::npos)
+        return value;
+
+    std::string result = "\"";
+    for ( const char c : value)
+        result += c == '"' ? std::string( "\"\"") : std::string( 1, c);
+    return result + '"';
+}
+
+static std::string json_string( const std::string& value)
+{
+    std::ostringstream out;
+    out << '"' << std::hex << std::setfill( '0');
+    for ( const char c : value) {
+        switch ( c) {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            // Other control characters, e.g. in messages of exceptions, cannot be written as is
+            if ( static_cast<unsigned char>( c) < 0x20)
+                out << "\\u" << std::setw( 4) << uint32( static_cast<unsigned char>( c));
+            else
+                out << c;
+        }
+    }
+    out << '"';
+    return std::move( out).str();
+}
+
+void save_sweep_csv( const std::vector<SweepResult>& results, std::ostream& out)
+{
+    const auto names = get_option_names( results);
+    for ( const auto& name : names)
+        out << csv_field( name) << ',';
+    out << "trap,instrs,cycles,ipc,mispredict_rate,icache_miss_rate,seconds,kips,error" << std::endl;
+
+    for ( const auto& result : results) {
+        for ( const auto& name : names) {
+            const auto it = result.point.find( name);
+            out << ( it != result.point.end() ? csv_field( it->second) : std::string()) << ',';
+        }
+        out << to_string( result.trap) << ',' << result.statistics.instrs << ',' << result.statistics.cycles
+            << ',' << result.get_ipc() << ',' << result.get_mispredict_rate() << ',' << result.get_icache_miss_rate()
+            << ',' << result.seconds << ',' << result.get_kips() << ',' << csv_field( result.error) << std::endl;
+    }
+}
+
+void save_sweep_json( const std::vector<SweepResult>& results, std::ostream& out)
+{
+    out << '[';
+    for ( size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        out << ( i == 0 ? "" : ",") << std::endl << "  { \"options\": {";
+        for ( auto it = result.point.begin(); it != result.point.end(); ++it)
+            out << ( it == result.point.begin() ? " " : ", ") << json_string( it->first) << ": " << json_string( it->second);
+        out << " }, \"trap\": " << json_string( to_string( result.trap))
+            << ", \"instrs\": " << result.statistics.instrs << ", \"cycles\": " << result.statistics.cycles
+            << ", \"ipc\": " << result.get_ipc() << ", \"mispredict_rate\": " << result.get_mispredict_rate()
+            << ", \"icache_miss_rate\": " << result.get_icache_miss_rate()
+            << ", \"seconds\": " << result.seconds << ", \"kips\": " << result.get_kips()
+            << ", \"error\": " << json_string( result.error) << " }";
+    }
+    out << std::endl << ']' << std::endl;
+}
@@ -0,0 +1,75 @@
+/*
+ * sweep.h - parallel simulation of a program over a grid of configurations
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <checkpoint/checkpoint.h>
+#include <func_sim/traps/trap.h>
+#include <infra/config/config.h>
+#include <infra/exception.h>
+#include <modules/core/sampling.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct SweepError final : Exception
+{
+    explicit SweepError( const std::string& msg)
+        : Exception("Invalid sweep grid", msg)
+    { }
+};
+
+// Option values of a single configuration, names are the ones of config::Value
+using SweepPoint = config::ScopedOverrides::Values;
+
+/*
+ * Grid description, one entry per line, '#' starts a comment:
+ *
+ *     bp-mode = saturating_two_bits, adaptive_two_levels
+ *     bp-size = 64, 128
+ *     point: icache-size=1024 icache-ways=2
+ *     point: icache-size=4096 icache-ways=4
+ *
+ * Values listed for an option form a cross product,
+ * each explicitly listed point is combined with every element of the product.
+ */
+std::vector<SweepPoint> parse_sweep_grid( std::istream& in);
+std::vector<SweepPoint> parse_sweep_grid( const std::string& filename);
+
+struct SweepParameters
+{
+    uint64 instrs = MAX_VAL64;
+    size_t threads = 0; // zero means all host threads
+};
+
+struct SweepResult
+{
+    SweepPoint point;
+    PerfStatistics statistics;
+    Trap trap = Trap( Trap::NO_TRAP);
+    double seconds = 0;
+    std::string error; // empty if simulation succeeded
+
+    double get_ipc() const;
+    double get_mispredict_rate() const;
+    double get_icache_miss_rate() const;
+    // Simulation speed in thousands of instructions per host second
+    double get_kips() const;
+};
+
+// Loads a program once with the configured ISA and kernel
+Checkpoint load_sweep_program( const std::string& filename);
+
+// Each point is simulated from the same start by its own simulator, results are in order of points.
+// Points are applied over config::ScopedOverrides of the calling thread.
+std::vector<SweepResult> run_sweep( const Checkpoint& start, const std::vector<SweepPoint>& points, const SweepParameters& params = {});
+
+// Tables have a column per swept option, followed by trap, statistics and speed
+void save_sweep_csv( const std::vector<SweepResult>& results, std::ostream& out);
+void save_sweep_json( const std::vector<SweepResult>& results, std::ostream& out);
+
+#endif // SWEEP_H
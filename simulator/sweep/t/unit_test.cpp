@@ -0,0 +1,121 @@
+/*
+ * Unit tests for configuration sweeps
+ * Copyright 2024 MIPT-MIPS
+ */
+
+#include <catch.hpp>
+
+#include <sweep/sweep.h>
+
+#include <sstream>
+
+static std::vector<SweepPoint> parse( const std::string& text)
+{
+    std::istringstream in( text);
+    return parse_sweep_grid( in);
+}
+
+TEST_CASE( "Sweep: cross product")
+{
+    const auto points = parse( "# branch prediction\n"
+                               "bp-mode = saturating_two_bits, adaptive_two_levels\n"
+                               "\n"
+                               "bp-size=64,128 , 256 # BTB entries\n");
+    REQUIRE( points.size() == 6);
+    CHECK( points[0] == SweepPoint{ { "bp-mode", "saturating_two_bits"}, { "bp-size", "64"}});
+    CHECK( points[2] == SweepPoint{ { "bp-mode", "saturating_two_bits"}, { "bp-size", "256"}});
+    CHECK( points[5] == SweepPoint{ { "bp-mode", "adaptive_two_levels"}, { "bp-size", "256"}});
+}
+
+TEST_CASE( "Sweep: explicit points combined with a product")
+{
+    const auto points = parse( "point: icache-size=1024 icache-ways=2\n"
+                               "point: icache-size=4096 icache-ways=4\n"
+                               "bp-size = 64, 128\n");
+    REQUIRE( points.size() == 4);
+    CHECK( points[0] == SweepPoint{ { "icache-size", "1024"}, { "icache-ways", "2"}, { "bp-size", "64"}});
+    CHECK( points[3] == SweepPoint{ { "icache-size", "4096"}, { "icache-ways", "4"}, { "bp-size", "128"}});
+}
+
+TEST_CASE( "Sweep: invalid grids")
+{
+    CHECK_THROWS_AS( parse( ""), SweepError);
+    CHECK_THROWS_AS( parse( "# nothing\n"), SweepError);
+    CHECK_THROWS_AS( parse( "bp-size\n"), SweepError);
+    CHECK_THROWS_AS( parse( "= 64\n"), SweepError);
+    CHECK_THROWS_AS( parse( "bp-size = 64,,128\n"), SweepError);
+    CHECK_THROWS_AS( parse( "bp-size = 64\nbp-size = 128\n"), SweepError);
+    CHECK_THROWS_AS( parse( "point:\n"), SweepError);
+    CHECK_THROWS_AS( parse( "point: bp-size\n"), SweepError);
+    CHECK_THROWS_AS( parse( "point: bp-size=64 bp-size=128\n"), SweepError);
+    CHECK_THROWS_AS( parse( "point: bp-size=64\nbp-size = 128\n"), SweepError);
+    CHECK_THROWS_AS( parse_sweep_grid( std::string( "/nonexistent.grid")), SweepError);
+}
+
+TEST_CASE( "Sweep: simulate points in parallel")
+{
+    const config::ScopedOverrides overrides( config::ScopedOverrides::Values{ { "mars", "true"}});
+    const auto start = load_sweep_program( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin");
+    const auto points = parse( "bp-mode = always_taken, saturating_two_bits, adaptive_two_levels\n"
+                               "icache-size = 1024, 4096\n"
+                               "point: bp-size=64\n"
+                               "point: bp-size=13\n");
+    REQUIRE( points.size() == 12);
+
+    SweepParameters params;
+    params.threads = 4;
+    const auto parallel = run_sweep( start, points, params);
+    params.threads = 1;
+    const auto sequential = run_sweep( start, points, params);
+
+    REQUIRE( parallel.size() == points.size());
+    for ( size_t i = 0; i < points.size(); ++i) {
+        CHECK( parallel[i].point == points[i]);
+        CHECK( parallel[i].error == sequential[i].error);
+        CHECK( parallel[i].statistics.cycles == sequential[i].statistics.cycles);
+        CHECK( parallel[i].statistics.instrs == sequential[i].statistics.instrs);
+        if ( points[i].at( "bp-size") == "64") {
+            CHECK( parallel[i].error.empty());
+            CHECK( parallel[i].trap == Trap::HALT);
+            CHECK( parallel[i].get_ipc() > 0);
+            CHECK( parallel[i].get_ipc() <= 1);
+            CHECK( parallel[i].get_kips() > 0);
+        }
+        else {
+            // BTB size must be a power of two
+            CHECK_FALSE( parallel[i].error.empty());
+        }
+    }
+    CHECK( parallel[0].statistics.instrs == parallel[2].statistics.instrs);
+    CHECK( parallel[0].statistics.cycles != parallel[2].statistics.cycles);
+
+    std::ostringstream csv;
+    save_sweep_csv( parallel, csv);
+    CHECK( csv.str().starts_with( "bp-mode,bp-size,icache-size,trap,instrs,cycles,ipc,mispredict_rate,icache_miss_rate,seconds,kips,error\n"
+                                  "always_taken,64,1024,HALT,"));
+
+    std::ostringstream json;
+    save_sweep_json( parallel, json);
+    CHECK( json.str().starts_with( "[\n  { \"options\": { \"bp-mode\": \"always_taken\", \"bp-size\": \"64\", \"icache-size\": \"1024\" }, \"trap\": \"HALT\""));
+}
+
+TEST_CASE( "Sweep: JSON escapes control characters")
+{
+    SweepResult result;
+    result.point = { { "bp-mode", "a\"b\\c"}};
+    result.trap = Trap( Trap::HALT);
+    result.error = "first line\nsecond\tline\r\x01";
+    std::ostringstream json;
+    save_sweep_json( { result}, json);
+    CHECK( json.str().find( R"("bp-mode": "a\"b\\c")") != std::string::npos);
+    CHECK( json.str().find( R"("error": "first line\nsecond\tline\r\u0001")") != std::string::npos);
+}
+
+TEST_CASE( "Sweep: unknown option")
+{
+    const auto start = load_sweep_program( TEST_PATH "/mips/mips-tt-no-delayed-branches.bin");
+    const auto results = run_sweep( start, { { { "no-such-option", "1"}}});
+    REQUIRE( results.size() == 1);
+    CHECK( results[0].error.find( "no-such-option") != std::string::npos);
+    CHECK( results[0].statistics.instrs == 0);
+}